@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2025 SternXD
+// SPDX-License-Identifier: MIT
+
+// Replaces the global operator new/delete to keep a running count of heap bytes per
+// thread, which is how Answer reports the peak allocation of each part. Counting per
+// thread keeps days running side by side under --all out of each other's numbers.
+// Every block carries a small header holding its size so delete knows what to subtract.
+
+#include "common.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+constexpr size_t HEADER_SIZE = alignof(std::max_align_t);
+
+// Signed, since a block freed on another thread than the one that allocated it is
+// subtracted from the thread that frees it
+thread_local int64_t current_bytes = 0;
+thread_local int64_t peak_bytes = 0;
+thread_local int64_t baseline_bytes = 0;
+
+void record_allocation(size_t size) {
+    current_bytes += static_cast<int64_t>(size);
+    peak_bytes = current_bytes > peak_bytes ? current_bytes : peak_bytes;
+}
+
+void* tracked_allocate(size_t size) noexcept {
+    void* block = std::malloc(size + HEADER_SIZE);
+    if (block == nullptr) {
+        return nullptr;
+    }
+    *static_cast<size_t*>(block) = size;
+    record_allocation(size);
+    return static_cast<char*>(block) + HEADER_SIZE;
+}
+
+void tracked_free(void* ptr) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    char* block = static_cast<char*>(ptr) - HEADER_SIZE;
+    current_bytes -= static_cast<int64_t>(*reinterpret_cast<size_t*>(block));
+    std::free(block);
+}
+
+void* tracked_allocate_or_throw(size_t size) {
+    void* ptr = tracked_allocate(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+} // anonymous namespace
+
+size_t peak_allocated_bytes() {
+    return static_cast<size_t>(peak_bytes - baseline_bytes);
+}
+
+void reset_peak_allocated_bytes() {
+    baseline_bytes = current_bytes;
+    peak_bytes = current_bytes;
+}
+
+void* operator new(size_t size) {
+    return tracked_allocate_or_throw(size);
+}
+
+void* operator new[](size_t size) {
+    return tracked_allocate_or_throw(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return tracked_allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return tracked_allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    tracked_free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    tracked_free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    tracked_free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    tracked_free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    tracked_free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    tracked_free(ptr);
+}
@@ -6,11 +6,235 @@
 #endif
 
 #include "common.h"
+#include "simd.h"
+#include <bit>
+#include <charconv>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <cstdlib>
 
-std::string read_puzzle_input(const std::string& key) {
+#if defined(__unix__) || defined(__APPLE__)
+#define AOC_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Below this size a plain read is cheaper than setting up a mapping
+constexpr size_t MIN_MAPPED_SIZE = 64 * 1024;
+
+std::string read_file(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw RisError("Could not open puzzle input file: " + path);
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+const char* find_char_scalar(const char* begin, const char* end, char c) {
+    const void* found = std::memchr(begin, c, static_cast<size_t>(end - begin));
+    return found != nullptr ? static_cast<const char*>(found) : end;
+}
+
+#ifdef AOC_HAVE_SSE2
+const char* find_char_sse2(const char* begin, const char* end, char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    for (; end - begin >= 16; begin += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+        if (mask != 0) {
+            return begin + std::countr_zero(mask);
+        }
+    }
+    return find_char_scalar(begin, end, c);
+}
+#endif
+
+#ifdef AOC_HAVE_AVX2
+AOC_TARGET_AVX2 const char* find_char_avx2(const char* begin, const char* end, char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    for (; end - begin >= 32; begin += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+        if (mask != 0) {
+            return begin + std::countr_zero(mask);
+        }
+    }
+    return find_char_sse2(begin, end, c);
+}
+#endif
+
+// 19 digits always fit in 64 bits, so shorter numbers need no overflow checks
+constexpr size_t MAX_SAFE_DIGITS = 19;
+
+bool is_eight_digits(uint64_t chunk) {
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+}
+
+// Combine 8 ASCII digits (little-endian load) pairwise: 2 -> 4 -> 8 digits per lane
+uint64_t parse_eight_digits(uint64_t chunk) {
+    chunk = ((chunk & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+    chunk = ((chunk & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+    return ((chunk & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+}
+
+using FindCharFn = const char* (*)(const char*, const char*, char);
+
+FindCharFn select_find_char() {
+#ifdef AOC_HAVE_AVX2
+    if (cpu_has_avx2()) {
+        return find_char_avx2;
+    }
+#endif
+#ifdef AOC_HAVE_SSE2
+    return find_char_sse2;
+#else
+    return find_char_scalar;
+#endif
+}
+
+} // anonymous namespace
+
+RisResult<uint64_t> parse_u64(std::string_view text) {
+    if (text.empty()) {
+        return ris_error_new_result("empty number");
+    }
+    
+    if (text.size() > MAX_SAFE_DIGITS) {
+        uint64_t value = 0;
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (result.ec != std::errc() || result.ptr != text.data() + text.size()) {
+            return ris_error_new_result("invalid or overflowing number");
+        }
+        return value;
+    }
+    
+    const char* p = text.data();
+    const char* end = p + text.size();
+    uint64_t value = 0;
+    
+    if constexpr (std::endian::native == std::endian::little) {
+        while (end - p >= 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, p, sizeof(chunk));
+            if (!is_eight_digits(chunk)) {
+                return ris_error_new_result("invalid digit");
+            }
+            value = value * 100000000 + parse_eight_digits(chunk);
+            p += 8;
+        }
+    }
+    
+    for (; p != end; ++p) {
+        unsigned digit = static_cast<unsigned char>(*p) - '0';
+        if (digit > 9) {
+            return ris_error_new_result("invalid digit");
+        }
+        value = value * 10 + digit;
+    }
+    
+    return value;
+}
+
+bool cpu_has_avx2() {
+#ifdef AOC_HAVE_AVX2
+    // AOC_DISABLE_AVX2 forces the fallbacks, to check them against the AVX2 kernels
+    static const bool supported = __builtin_cpu_supports("avx2") && std::getenv("AOC_DISABLE_AVX2") == nullptr;
+    return supported;
+#else
+    return false;
+#endif
+}
+
+const char* find_char(const char* begin, const char* end, char c) {
+    static const FindCharFn impl = select_find_char();
+    return impl(begin, end, c);
+}
+
+MappedInput::MappedInput(const std::string& path) {
+#ifdef AOC_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw RisError("Could not open puzzle input file: " + path);
+    }
+    
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= MIN_MAPPED_SIZE) {
+        size_t size = static_cast<size_t>(info.st_size);
+        void* addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            // Parsers walk the input front to back exactly once
+            ::madvise(addr, size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+            ::madvise(addr, size, MADV_HUGEPAGE);
+#endif
+            mapping_ = static_cast<const char*>(addr);
+            size_ = size;
+        }
+    }
+    ::close(fd);
+    
+    if (mapping_ != nullptr) {
+        return;
+    }
+#endif
+    buffer_ = read_file(path);
+}
+
+MappedInput::~MappedInput() {
+    unmap();
+}
+
+MappedInput::MappedInput(MappedInput&& other) noexcept
+    : mapping_(other.mapping_), size_(other.size_), buffer_(std::move(other.buffer_)) {
+    other.mapping_ = nullptr;
+    other.size_ = 0;
+}
+
+MappedInput& MappedInput::operator=(MappedInput&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        mapping_ = other.mapping_;
+        size_ = other.size_;
+        buffer_ = std::move(other.buffer_);
+        other.mapping_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void MappedInput::prefault() const {
+#ifdef AOC_HAVE_MMAP
+    if (mapping_ == nullptr) {
+        return;
+    }
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    // volatile so the loads aren't optimized away
+    volatile char sink = 0;
+    for (size_t offset = 0; offset < size_; offset += page) {
+        sink = sink + mapping_[offset];
+    }
+#endif
+}
+
+void MappedInput::unmap() {
+#ifdef AOC_HAVE_MMAP
+    if (mapping_ != nullptr) {
+        ::munmap(const_cast<char*>(mapping_), size_);
+    }
+#endif
+    mapping_ = nullptr;
+    size_ = 0;
+}
+
+std::string find_puzzle_input(const std::string& key) {
     std::string filename = key;
     std::vector<std::string> possible_paths;
     
@@ -48,9 +272,7 @@ std::string read_puzzle_input(const std::string& key) {
     for (const auto& path : possible_paths) {
         std::ifstream file(path);
         if (file.is_open()) {
-            std::stringstream buffer;
-            buffer << file.rdbuf();
-            return buffer.str();
+            return path;
         }
     }
     
@@ -65,3 +287,190 @@ std::string read_puzzle_input(const std::string& key) {
     throw RisError(error_msg);
 }
 
+std::string read_puzzle_input(const std::string& key) {
+    return read_file(find_puzzle_input(key));
+}
+
+MappedInput map_puzzle_input(const std::string& key) {
+    return MappedInput(find_puzzle_input(key));
+}
+
+
+namespace {
+
+const char* type_name(const AnswerValue& value) {
+    switch (value.index()) {
+        case 0: return "u64";
+        case 1: return "i64";
+        default: return "string";
+    }
+}
+
+// Quote CSV fields only when they need it
+void write_csv_value(std::ostream& out, const AnswerValue& value) {
+    std::string text = to_string(value);
+    if (text.find_first_of(",\"\n") == std::string::npos) {
+        out << text;
+        return;
+    }
+    out << '"';
+    for (char c : text) {
+        out << c;
+        if (c == '"') {
+            out << '"';
+        }
+    }
+    out << '"';
+}
+
+} // anonymous namespace
+
+std::string to_string(const AnswerValue& value) {
+    return std::visit([](const auto& v) -> std::string {
+        if constexpr (std::is_same_v<std::decay_t<decltype(v)>, std::string>) {
+            return v;
+        } else {
+            return std::to_string(v);
+        }
+    }, value);
+}
+
+void write_json_string(std::ostream& out, std::string_view text) {
+    out << '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            case '\b': out << "\\b"; break;
+            case '\f': out << "\\f"; break;
+            default:
+                // JSON allows no raw control characters in a string
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    const char* hex = "0123456789abcdef";
+                    out << "\\u00" << hex[c >> 4] << hex[c & 0xf];
+                } else {
+                    out << c;
+                }
+                break;
+        }
+    }
+    out << '"';
+}
+
+void write_json_value(std::ostream& out, const AnswerValue& value) {
+    if (const std::string* text = std::get_if<std::string>(&value)) {
+        write_json_string(out, *text);
+    } else {
+        out << to_string(value);
+    }
+}
+
+RisResult<OutputFormat> parse_output_format(std::string_view name) {
+    if (name == "text") {
+        return OutputFormat::Text;
+    }
+    if (name == "json") {
+        return OutputFormat::Json;
+    }
+    if (name == "csv") {
+        return OutputFormat::Csv;
+    }
+    return ris_error_new_result("unknown output format");
+}
+
+void Answer::print(std::ostream& out) const {
+    for (const auto& result : results_) {
+        out << result.part << ": " << to_string(result.value) << std::endl;
+    }
+}
+
+void Answer::print_json(std::ostream& out) const {
+    out << "{\"day\": " << day_ << ", \"parts\": [";
+    for (size_t i = 0; i < results_.size(); ++i) {
+        const PartResult& result = results_[i];
+        out << (i > 0 ? ", " : "")
+            << "{\"part\": " << result.part
+            << ", \"type\": \"" << type_name(result.value) << "\""
+            << ", \"value\": ";
+        write_json_value(out, result.value);
+        out << ", \"elapsed_ns\": " << result.elapsed.count()
+            << ", \"peak_alloc_bytes\": " << result.peak_allocated << "}";
+    }
+    out << "]}" << std::endl;
+}
+
+void Answer::print_csv_header(std::ostream& out) {
+    out << "day,part,type,value,elapsed_ns,peak_alloc_bytes" << std::endl;
+}
+
+void Answer::print_csv(std::ostream& out) const {
+    for (const auto& result : results_) {
+        out << day_ << "," << result.part << "," << type_name(result.value) << ",";
+        write_csv_value(out, result.value);
+        out << "," << result.elapsed.count() << "," << result.peak_allocated << std::endl;
+    }
+}
+
+void Answer::print(OutputFormat format, std::ostream& out) const {
+    switch (format) {
+        case OutputFormat::Text:
+            print(out);
+            break;
+        case OutputFormat::Json:
+            print_json(out);
+            break;
+        case OutputFormat::Csv:
+            print_csv_header(out);
+            print_csv(out);
+            break;
+    }
+}
+
+DayRegistry& DayRegistry::instance() {
+    static DayRegistry registry;
+    return registry;
+}
+
+void DayRegistry::add(const DayInfo& info) {
+    if (!days_.emplace(info.day, info).second) {
+        throw RisError("Day " + std::to_string(info.day) + " is registered twice");
+    }
+}
+
+const DayInfo* DayRegistry::find(int day) const {
+    auto it = days_.find(day);
+    return it != days_.end() ? &it->second : nullptr;
+}
+
+namespace {
+
+// Run one part, recording its wall time and how far the heap grew while it ran
+template<typename F>
+void run_part(Answer& answer, F&& part) {
+    reset_peak_allocated_bytes();
+    
+    auto start = std::chrono::steady_clock::now();
+    AnswerValue value = part();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    
+    answer.add(std::move(value), elapsed, peak_allocated_bytes());
+}
+
+} // anonymous namespace
+
+void run_solution(DaySolution& solution, Answer& answer, std::ostream& log) {
+    log << "read input..." << std::endl;
+    MappedInput input = map_puzzle_input(solution.input_key());
+    
+    log << "parse input..." << std::endl;
+    solution.parse(input.view());
+    
+    log << "run part 1..." << std::endl;
+    run_part(answer, [&] { return solution.part_1(); });
+    
+    log << "run part 2..." << std::endl;
+    run_part(answer, [&] { return solution.part_2(); });
+}
@@ -3,11 +3,19 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <optional>
 #include <stdexcept>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <utility>
+#include <variant>
 
 class RisError : public std::runtime_error {
 public:
@@ -21,27 +29,276 @@ using RisResult = std::optional<T>;
 #define ris_error_new(msg) RisError(msg)
 #define ris_error_new_result(msg) std::nullopt
 
+// A single puzzle answer, kept typed so it can be emitted without reformatting
+using AnswerValue = std::variant<uint64_t, int64_t, std::string>;
+
+std::string to_string(const AnswerValue& value);
+
+// Numbers as JSON numbers, strings quoted and escaped
+void write_json_value(std::ostream& out, const AnswerValue& value);
+void write_json_string(std::ostream& out, std::string_view text);
+
+// One solved part along with what it cost
+struct PartResult {
+    int part;
+    AnswerValue value;
+    std::chrono::nanoseconds elapsed{0};
+    size_t peak_allocated = 0; // bytes above the heap usage at the start of the part, on its thread
+};
+
+enum class OutputFormat {
+    Text,
+    Json,
+    Csv
+};
+
+RisResult<OutputFormat> parse_output_format(std::string_view name);
+
 // Answer structure to store results
 class Answer {
 public:
-    void add(const std::string& result) {
-        results_.push_back(result);
+    explicit Answer(int day = 0) : day_(day) {}
+    
+    void add(AnswerValue value, std::chrono::nanoseconds elapsed = {}, size_t peak_allocated = 0) {
+        int part = static_cast<int>(results_.size()) + 1;
+        results_.push_back(PartResult{part, std::move(value), elapsed, peak_allocated});
+    }
+    
+    int day() const {
+        return day_;
     }
     
-    const std::vector<std::string>& get_results() const {
+    const std::vector<PartResult>& get_results() const {
         return results_;
     }
     
-    void print() const {
-        for (const auto& result : results_) {
-            std::cout << result << std::endl;
-        }
+    // "1: 1234" per part
+    void print(std::ostream& out = std::cout) const;
+    
+    // {"day": N, "parts": [{"part": 1, "type": "u64", "value": ..., "elapsed_ns": ..., "peak_alloc_bytes": ...}]}
+    void print_json(std::ostream& out = std::cout) const;
+    
+    // One "day,part,type,value,elapsed_ns,peak_alloc_bytes" row per part
+    void print_csv(std::ostream& out = std::cout) const;
+    static void print_csv_header(std::ostream& out = std::cout);
+    
+    void print(OutputFormat format, std::ostream& out = std::cout) const;
+
+private:
+    int day_;
+    std::vector<PartResult> results_;
+};
+
+// How far this thread's heap usage through the global operator new has risen above
+// where it was at the last reset_peak_allocated_bytes() on the same thread. The count is
+// per thread: what other threads allocate, pool helpers included, isn't in it.
+size_t peak_allocated_bytes();
+void reset_peak_allocated_bytes();
+
+// A day's solution split into phases, so each one can be called (and timed) on its own
+class DaySolution {
+public:
+    explicit DaySolution(std::string input_key) : input_key_(std::move(input_key)) {}
+    virtual ~DaySolution() = default;
+    
+    const std::string& input_key() const {
+        return input_key_;
+    }
+    
+    virtual void parse(std::string_view input) = 0;
+    virtual AnswerValue part_1() const = 0;
+    virtual AnswerValue part_2() const = 0;
+    
+    // Days that can solve both parts straight from a byte stream, in one pass and
+    // constant memory, override this. Nothing means the day needs its whole input.
+    virtual RisResult<std::pair<AnswerValue, AnswerValue>> solve_stream(std::istream& /*input*/) {
+        return std::nullopt;
+    }
+    
+    // Days with a slower, obviously correct path recompute both parts from the raw input
+    // with it here, so --verify can check the fast path, reporting any details on
+    // `log`. Nothing means no reference.
+    virtual RisResult<std::pair<AnswerValue, AnswerValue>> reference_parts(std::string_view /*input*/, std::ostream& /*log*/) const {
+        return std::nullopt;
+    }
+
+private:
+    std::string input_key_;
+};
+
+// What the drivers know about a day without running it
+struct DayInfo {
+    int day;
+    const char* title;
+    std::unique_ptr<DaySolution> (*create)();
+};
+
+// Every day adds itself here from its own translation unit (see AOC_REGISTER_DAY),
+// so main.cpp never needs to know which days exist.
+class DayRegistry {
+public:
+    static DayRegistry& instance();
+    
+    void add(const DayInfo& info);
+    
+    // nullptr if the day isn't implemented
+    const DayInfo* find(int day) const;
+    
+    const std::map<int, DayInfo>& days() const {
+        return days_;
     }
 
 private:
-    std::vector<std::string> results_;
+    std::map<int, DayInfo> days_;
 };
 
+template<typename Solution>
+struct DayRegistrar {
+    DayRegistrar(int day, const char* title) {
+        DayRegistry::instance().add(DayInfo{day, title, &create});
+    }
+    
+    static std::unique_ptr<DaySolution> create() {
+        return std::make_unique<Solution>();
+    }
+};
+
+#define AOC_REGISTER_DAY(day, title, Solution) \
+    static const DayRegistrar<Solution> day_registrar_##day(day, title)
+
+// Read-only view of an input file. Large files are memory-mapped so they are never
+// copied; small files (or platforms without mmap) are read into an owned buffer.
+class MappedInput {
+public:
+    explicit MappedInput(const std::string& path);
+    ~MappedInput();
+    
+    MappedInput(MappedInput&& other) noexcept;
+    MappedInput& operator=(MappedInput&& other) noexcept;
+    MappedInput(const MappedInput&) = delete;
+    MappedInput& operator=(const MappedInput&) = delete;
+    
+    std::string_view view() const {
+        return mapping_ != nullptr ? std::string_view(mapping_, size_) : std::string_view(buffer_);
+    }
+    
+    bool is_mapped() const {
+        return mapping_ != nullptr;
+    }
+    
+    // Touch every page of a mapping so the file is actually read now rather than on
+    // first access; a no-op for buffered input. --bench calls it inside its read phase,
+    // since otherwise the page faults that read a mapped file are charged to parsing.
+    void prefault() const;
+
+private:
+    void unmap();
+    
+    const char* mapping_ = nullptr;
+    size_t size_ = 0;
+    std::string buffer_;
+};
+
+// resolve the path of a puzzle input file
+std::string find_puzzle_input(const std::string& key);
+
 // read puzzle input
 std::string read_puzzle_input(const std::string& key);
 
+// map puzzle input without copying it
+MappedInput map_puzzle_input(const std::string& key);
+
+// read, parse and solve both parts, reporting progress on `log`
+void run_solution(DaySolution& solution, Answer& answer, std::ostream& log = std::cout);
+
+// Parse an unsigned decimal number that spans the whole view, without allocating.
+// Returns nothing for empty input, stray characters or values that overflow 64 bits.
+RisResult<uint64_t> parse_u64(std::string_view text);
+
+// true when the CPU running us supports AVX2 and AOC_DISABLE_AVX2 isn't set
+bool cpu_has_avx2();
+
+// Pointer to the first `c` in [begin, end), or `end`. Scans 32 (AVX2) or 16 (SSE2)
+// bytes at a time where available.
+const char* find_char(const char* begin, const char* end, char c);
+
+// Splits a view on `delimiter` without allocating; each field is a view into the input.
+// A trailing delimiter does not produce an extra empty field, like std::getline.
+class FieldSplitter {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = const std::string_view&;
+        
+        iterator(const char* begin, const char* end, char delimiter, bool strip_cr)
+            : cursor_(begin), end_(end), delimiter_(delimiter), strip_cr_(strip_cr) {
+            advance();
+        }
+        
+        reference operator*() const {
+            return field_;
+        }
+        
+        iterator& operator++() {
+            advance();
+            return *this;
+        }
+        
+        void operator++(int) {
+            advance();
+        }
+        
+        bool operator==(std::default_sentinel_t) const {
+            return done_;
+        }
+
+    private:
+        void advance() {
+            if (cursor_ == end_) {
+                done_ = true;
+                return;
+            }
+            
+            const char* stop = find_char(cursor_, end_, delimiter_);
+            const char* field_end = stop;
+            if (strip_cr_ && field_end != cursor_ && field_end[-1] == '\r') {
+                --field_end;
+            }
+            field_ = std::string_view(cursor_, static_cast<size_t>(field_end - cursor_));
+            cursor_ = stop == end_ ? end_ : stop + 1;
+        }
+        
+        const char* cursor_;
+        const char* end_;
+        char delimiter_;
+        bool strip_cr_;
+        bool done_ = false;
+        std::string_view field_;
+    };
+    
+    FieldSplitter(std::string_view input, char delimiter, bool strip_cr = false)
+        : input_(input), delimiter_(delimiter), strip_cr_(strip_cr) {}
+    
+    iterator begin() const {
+        return iterator(input_.data(), input_.data() + input_.size(), delimiter_, strip_cr_);
+    }
+    
+    std::default_sentinel_t end() const {
+        return std::default_sentinel;
+    }
+
+private:
+    std::string_view input_;
+    char delimiter_;
+    bool strip_cr_;
+};
+
+// Splits a view into lines, accepting both \n and \r\n line endings
+class LineSplitter : public FieldSplitter {
+public:
+    explicit LineSplitter(std::string_view input) : FieldSplitter(input, '\n', true) {}
+};
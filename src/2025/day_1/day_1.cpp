@@ -2,16 +2,18 @@
 // SPDX-License-Identifier: MIT
 
 #include "day_1.h"
-#include <sstream>
+#include "../profile.h"
+#include "../thread_pool.h"
+#include <algorithm>
 #include <iostream>
 
-Rotation Rotation::from_string(const std::string& line) {
+Rotation Rotation::from_string(std::string_view line) {
     if (line.empty()) {
         throw RisError("Empty line cannot be converted to Rotation");
     }
     
-    char direction_char = std::tolower(line[0]);
-    std::string clicks_str = line.substr(1);
+    char direction_char = std::tolower(static_cast<unsigned char>(line[0]));
+    std::string_view clicks_str = line.substr(1);
     
     Direction direction;
     if (direction_char == 'l') {
@@ -22,83 +24,234 @@ Rotation Rotation::from_string(const std::string& line) {
         throw RisError("Invalid direction: " + std::string(1, direction_char));
     }
     
-    size_t clicks;
-    try {
-        clicks = std::stoull(clicks_str);
-    } catch (const std::exception&) {
-        throw RisError("Invalid clicks value: " + clicks_str);
+    RisResult<uint64_t> clicks = parse_u64(clicks_str);
+    if (!clicks) {
+        throw RisError("Invalid clicks value: " + std::string(clicks_str));
     }
     
-    return Rotation{direction, clicks};
+    return Rotation{direction, *clicks};
+}
+
+Rotation RotationList::operator[](size_t index) const {
+    int32_t delta = deltas_[index];
+    if (delta == OVERFLOW_DELTA) {
+        auto it = std::lower_bound(overflow_.begin(), overflow_.end(), index,
+            [](const std::pair<size_t, Rotation>& entry, size_t i) { return entry.first < i; });
+        return it->second;
+    }
+    if (delta < 0) {
+        return Rotation{Direction::Left, static_cast<size_t>(-static_cast<int64_t>(delta))};
+    }
+    return Rotation{Direction::Right, static_cast<size_t>(delta)};
 }
 
 namespace {
 
 const std::string PUZZLE_INPUT_KEY = "day_1";
 
-size_t run_part_1(const std::vector<Rotation>& rotations) {
+// Below this many rotations per chunk, threads cost more than they save
+const size_t MIN_CHUNK_SIZE = 1 << 16;
+
+// Read size for streaming input; the only buffer the stream needs
+const size_t STREAM_BLOCK_SIZE = 1 << 16;
+
+// Net rotation of a run of rotations, as the position a dial starting at 0 ends on
+size_t net_offset(const RotationList& rotations, size_t begin, size_t end) {
     Dial<100> dial;
-    size_t counter = 0;
-    
-    for (const auto& rotation : rotations) {
-        dial.add(rotation);
-        
-        if (dial.position == 0) {
-            counter++;
-        }
-    }
-    
-    return counter;
+    dial.position = 0;
+    dial.advance(rotations, begin, end);
+    return dial.position;
 }
 
-size_t run_part_2(const std::vector<Rotation>& rotations) {
+// The serial path: apply the rotations in turn to a Dial<100> starting at `start`
+ZeroCounts count_zeros_serial(const RotationList& rotations, size_t begin, size_t end, size_t start) {
     Dial<100> dial;
-    size_t counter = 0;
+    dial.position = start;
+    return dial.apply(rotations, begin, end);
+}
+
+class Day1Solution : public DaySolution {
+public:
+    Day1Solution() : DaySolution(PUZZLE_INPUT_KEY) {}
     
-    for (const auto& rotation : rotations) {
-        // Apply rotations one click at a time
-        for (size_t i = 0; i < rotation.clicks; ++i) {
-            Rotation single_click{rotation.direction, 1};
-            dial.add(single_click);
+    void parse(std::string_view input) override {
+        AOC_SCOPE("day1.parse");
+        rotations_.clear();
+        
+        for (std::string_view line : LineSplitter(input)) {
+            if (line.empty()) {
+                continue;
+            }
             
-            if (dial.position == 0) {
-                counter++;
+            try {
+                rotations_.push_back(Rotation::from_string(line));
+            } catch (const RisError& e) {
+                std::cerr << "Error parsing line: " << line << " - " << e.what() << std::endl;
+                throw;
             }
         }
     }
     
-    return counter;
-}
+    RisResult<std::pair<AnswerValue, AnswerValue>> solve_stream(std::istream& input) override {
+        AOC_SCOPE("day1.stream");
+        ZeroCounts counts = count_zeros_stream(input);
+        return std::make_pair(AnswerValue(counts.stops), AnswerValue(counts.clicks));
+    }
+    
+    AnswerValue part_1() const override {
+        AOC_SCOPE("day1.part1");
+        return count_zeros(rotations_).stops;
+    }
+    
+    AnswerValue part_2() const override {
+        AOC_SCOPE("day1.part2");
+        return count_zeros(rotations_).clicks;
+    }
+    
+    // Plain Rotation vector and one Dial<100> stepped in order: no packing, chunking
+    // or stream state shared with the fast paths
+    RisResult<std::pair<AnswerValue, AnswerValue>> reference_parts(std::string_view input, std::ostream& /*log*/) const override {
+        AOC_SCOPE("day1.reference");
+        std::vector<Rotation> rotations;
+        for (std::string_view line : LineSplitter(input)) {
+            if (!line.empty()) {
+                rotations.push_back(Rotation::from_string(line));
+            }
+        }
+        
+        Dial<100> stop_dial;
+        Dial<100> click_dial;
+        size_t stops = 0;
+        size_t clicks = 0;
+        for (const Rotation& rotation : rotations) {
+            stop_dial.add(rotation);
+            stops += stop_dial.position == 0;
+            clicks += click_dial.add_counting_zeros(rotation);
+        }
+        return std::make_pair(AnswerValue(stops), AnswerValue(clicks));
+    }
+
+private:
+    RotationList rotations_;
+};
+
+AOC_REGISTER_DAY(1, "Secret Entrance", Day1Solution);
+
 } // namespace
 
-void run_day_1(Answer& answer) {
-    std::cout << "read input..." << std::endl;
-    std::string input = read_puzzle_input(PUZZLE_INPUT_KEY);
+ZeroCounts count_zeros(const RotationList& rotations, size_t start, size_t threads) {
+    if (threads == 0) {
+        threads = compute_pool().size();
+    }
+    size_t chunks = std::clamp<size_t>((rotations.size() + MIN_CHUNK_SIZE - 1) / MIN_CHUNK_SIZE, 1, threads);
+    size_t chunk_size = (rotations.size() + chunks - 1) / chunks;
+    
+    auto chunk_begin = [&](size_t chunk) { return std::min(chunk * chunk_size, rotations.size()); };
+    
+    // Pass 1: net offset of every chunk, in parallel
+    std::vector<size_t> offsets(chunks, 0);
+    if (chunks > 1) {
+        parallel_for(chunks, [&](size_t chunk) {
+            offsets[chunk] = net_offset(rotations, chunk_begin(chunk), chunk_begin(chunk + 1));
+        }, threads);
+    }
+    
+    // Exclusive scan of the offsets gives each chunk's starting position
+    std::vector<size_t> starts(chunks);
+    size_t position = start % 100;
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        starts[chunk] = position;
+        position = (position + offsets[chunk]) % 100;
+    }
     
-    std::cout << "parse input..." << std::endl;
-    std::vector<Rotation> rotations;
+    // Pass 2: count zeros in every chunk from its known start, in parallel
+    std::vector<ZeroCounts> counts(chunks);
+    parallel_for(chunks, [&](size_t chunk) {
+        counts[chunk] = count_zeros_serial(rotations, chunk_begin(chunk), chunk_begin(chunk + 1), starts[chunk]);
+    }, threads);
     
-    std::istringstream iss(input);
-    std::string line;
-    while (std::getline(iss, line)) {
-        if (line.empty()) {
-            continue;
+    ZeroCounts total;
+    for (const auto& chunk_counts : counts) {
+        total.stops += chunk_counts.stops;
+        total.clicks += chunk_counts.clicks;
+    }
+    return total;
+}
+
+void ZeroCountStream::feed(std::string_view bytes) {
+    for (char c : bytes) {
+        // A \r only ends a line when \n follows; anywhere else it's part of the line
+        if (pending_cr_) {
+            pending_cr_ = false;
+            if (c != '\n') {
+                consume('\r');
+            }
         }
         
-        try {
-            rotations.push_back(Rotation::from_string(line));
-        } catch (const RisError& e) {
-            std::cerr << "Error parsing line: " << line << " - " << e.what() << std::endl;
-            throw;
+        if (c == '\n') {
+            end_line();
+        } else if (c == '\r') {
+            pending_cr_ = true;
+        } else {
+            consume(c);
+        }
+    }
+}
+
+ZeroCounts ZeroCountStream::finish() {
+    pending_cr_ = false;
+    end_line();
+    return counts_;
+}
+
+void ZeroCountStream::consume(char c) {
+    if (!in_line_) {
+        char direction_char = std::tolower(static_cast<unsigned char>(c));
+        if (direction_char == 'l') {
+            direction_ = Direction::Left;
+        } else if (direction_char == 'r') {
+            direction_ = Direction::Right;
+        } else {
+            throw RisError("Invalid direction on line " + std::to_string(line_) + ": " + std::string(1, direction_char));
         }
+        in_line_ = true;
+        return;
     }
     
-    std::cout << "run part 1..." << std::endl;
-    size_t result1 = run_part_1(rotations);
-    answer.add("1: " + std::to_string(result1));
+    uint64_t digit = static_cast<uint64_t>(c - '0');
+    if (digit > 9 || clicks_ > (UINT64_MAX - digit) / 10) {
+        throw RisError("Invalid clicks value on line " + std::to_string(line_));
+    }
+    clicks_ = clicks_ * 10 + digit;
+    ++digits_;
+}
+
+void ZeroCountStream::end_line() {
+    if (in_line_) {
+        if (digits_ == 0) {
+            throw RisError("Invalid clicks value on line " + std::to_string(line_));
+        }
+        counts_.clicks += dial_.add_counting_zeros(Rotation{direction_, clicks_});
+        counts_.stops += dial_.position == 0;
+    }
     
-    std::cout << "run part 2..." << std::endl;
-    size_t result2 = run_part_2(rotations);
-    answer.add("2: " + std::to_string(result2));
+    ++line_;
+    in_line_ = false;
+    clicks_ = 0;
+    digits_ = 0;
 }
 
+ZeroCounts count_zeros_stream(std::istream& input, size_t start) {
+    ZeroCountStream stream(start);
+    std::vector<char> block(STREAM_BLOCK_SIZE);
+    
+    while (input) {
+        input.read(block.data(), static_cast<std::streamsize>(block.size()));
+        stream.feed(std::string_view(block.data(), static_cast<size_t>(input.gcount())));
+    }
+    if (input.bad()) {
+        throw RisError("Failed to read input stream");
+    }
+    
+    return stream.finish();
+}
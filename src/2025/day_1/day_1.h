@@ -4,9 +4,15 @@
 #pragma once
 
 #include "../common.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include <cctype>
+#include <istream>
 
 // Direction enum
 enum class Direction {
@@ -19,24 +25,102 @@ struct Rotation {
     Direction direction;
     size_t clicks;
     
-    static Rotation from_string(const std::string& line);
+    static Rotation from_string(std::string_view line);
 };
 
-// Dial template structure
+// How often the dial rests on 0 after a rotation (part 1), and how many clicks in
+// total land on 0 (part 2)
+struct ZeroCounts {
+    size_t stops = 0;
+    size_t clicks = 0;
+};
+
+// Rotations packed as signed click deltas, right positive and left negative: 4 bytes
+// each instead of a 16-byte Rotation. Click counts that don't fit in 31 bits store
+// OVERFLOW_DELTA and keep their real rotation in a side table.
+class RotationList {
+public:
+    static constexpr int32_t OVERFLOW_DELTA = INT32_MIN;
+    
+    void push_back(const Rotation& rotation) {
+        if (rotation.clicks <= static_cast<size_t>(INT32_MAX)) {
+            int32_t clicks = static_cast<int32_t>(rotation.clicks);
+            deltas_.push_back(rotation.direction == Direction::Right ? clicks : -clicks);
+        } else {
+            overflow_.emplace_back(deltas_.size(), rotation);
+            deltas_.push_back(OVERFLOW_DELTA);
+        }
+    }
+    
+    Rotation operator[](size_t index) const;
+    
+    size_t size() const {
+        return deltas_.size();
+    }
+    
+    bool empty() const {
+        return deltas_.empty();
+    }
+    
+    void clear() {
+        deltas_.clear();
+        overflow_.clear();
+    }
+    
+    const std::vector<int32_t>& deltas() const {
+        return deltas_;
+    }
+    
+    // (index, rotation) for every OVERFLOW_DELTA entry, by index
+    const std::vector<std::pair<size_t, Rotation>>& overflow() const {
+        return overflow_;
+    }
+
+private:
+    std::vector<int32_t> deltas_;
+    std::vector<std::pair<size_t, Rotation>> overflow_;
+};
+
+// Largest modulus a dial takes, so batch arithmetic stays in 32 bits
+constexpr size_t MAX_DIAL_MODULUS = size_t{1} << 31;
+
+// Dial template structure. Dial<0> takes its modulus at runtime instead.
 template<size_t T>
 class Dial {
+    static_assert(T <= MAX_DIAL_MODULUS, "Dial modulus must be at most 2^31");
+
 public:
     size_t position;
     
-    Dial() : position(50) {}
+    Dial() : position(50) {
+        static_assert(T != 0, "Dial<0> needs a runtime modulus");
+    }
+    
+    // Runtime modulus in (0, 2^31]
+    explicit Dial(size_t modulus, size_t start = 50) : position(0), modulus_(modulus) {
+        static_assert(T == 0, "Dial<T> has a compile-time modulus");
+        if (modulus == 0 || modulus > MAX_DIAL_MODULUS) {
+            throw RisError("Dial modulus must be in 1.." + std::to_string(MAX_DIAL_MODULUS) + ", got " + std::to_string(modulus));
+        }
+        position = start % modulus;
+    }
+    
+    size_t modulus() const {
+        if constexpr (T != 0) {
+            return T;
+        } else {
+            return modulus_;
+        }
+    }
     
     void add(const Rotation& rotation) {
-        size_t clicks_to_apply = rotation.clicks % T;
+        const size_t m = modulus();
+        size_t clicks_to_apply = rotation.clicks % m;
         
         switch (rotation.direction) {
             case Direction::Left:
                 if (clicks_to_apply > position) {
-                    position += T - clicks_to_apply;
+                    position += m - clicks_to_apply;
                 } else {
                     position -= clicks_to_apply;
                 }
@@ -44,14 +128,188 @@ public:
                 
             case Direction::Right:
                 position += clicks_to_apply;
-                if (position >= T) {
-                    position -= T;
+                if (position >= m) {
+                    position -= m;
+                }
+                break;
+        }
+    }
+    
+    // Apply a rotation and return how many of its clicks land on 0, in O(1)
+    // regardless of the click count. Exact for any 64-bit click count.
+    size_t add_counting_zeros(const Rotation& rotation) {
+        const size_t m = modulus();
+        size_t zeros = 0;
+        
+        switch (rotation.direction) {
+            case Direction::Left: {
+                // Zero is first reached after `position` clicks (a full turn when already on it)
+                size_t first_zero = position == 0 ? m : position;
+                if (rotation.clicks >= first_zero) {
+                    zeros = (rotation.clicks - first_zero) / m + 1;
                 }
                 break;
+            }
+                
+            case Direction::Right:
+                // floor((position + clicks) / m), split up so it can't overflow
+                zeros = rotation.clicks / m + (position + rotation.clicks % m) / m;
+                break;
+        }
+        
+        add(rotation);
+        return zeros;
+    }
+    
+    // Apply packed deltas (no OVERFLOW_DELTA entries) and count zeros. Works in blocks:
+    // the per-delta steps and zero counts have no dependency between elements and are
+    // written branch-free so they vectorize; only the running position is serial.
+    ZeroCounts apply_batch(const int32_t* deltas, size_t count) {
+        constexpr size_t BLOCK = 256;
+        const uint32_t m = static_cast<uint32_t>(modulus());
+        uint32_t steps[BLOCK];
+        uint32_t before[BLOCK];
+        uint32_t pos = static_cast<uint32_t>(position);
+        ZeroCounts counts;
+        
+        for (size_t base = 0; base < count; base += BLOCK) {
+            const int32_t* block = deltas + base;
+            const size_t n = std::min(BLOCK, count - base);
+            
+            for (size_t i = 0; i < n; ++i) {
+                steps[i] = forward_step(block[i], m);
+            }
+            
+            for (size_t i = 0; i < n; ++i) {
+                before[i] = pos;
+                pos += steps[i];
+                pos -= pos >= m ? m : 0;
+            }
+            
+            uint32_t stops = 0;
+            uint64_t clicks = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const uint32_t p = before[i];
+                const uint32_t magnitude = magnitude_of(block[i]);
+                uint32_t after = p + steps[i];
+                after -= after >= m ? m : 0;
+                stops += after == 0;
+                
+                // Same formulas as add_counting_zeros; p + magnitude < 2^32
+                const uint32_t first_zero = p == 0 ? m : p;
+                const uint32_t left = magnitude >= first_zero ? (magnitude - first_zero) / m + 1 : 0;
+                const uint32_t right = (p + magnitude) / m;
+                clicks += block[i] < 0 ? left : right;
+            }
+            counts.stops += stops;
+            counts.clicks += clicks;
         }
+        
+        position = pos;
+        return counts;
     }
+    
+    // Apply rotations [begin, end) of a list and count zeros
+    ZeroCounts apply(const RotationList& rotations, size_t begin, size_t end) {
+        ZeroCounts counts;
+        const int32_t* deltas = rotations.deltas().data();
+        auto overflow = overflow_from(rotations, begin);
+        
+        while (begin < end) {
+            size_t stop = overflow != rotations.overflow().end() ? std::min(overflow->first, end) : end;
+            ZeroCounts batch = apply_batch(deltas + begin, stop - begin);
+            counts.stops += batch.stops;
+            counts.clicks += batch.clicks;
+            
+            begin = stop;
+            if (begin < end) {
+                counts.clicks += add_counting_zeros(overflow->second);
+                counts.stops += position == 0;
+                ++overflow;
+                ++begin;
+            }
+        }
+        
+        return counts;
+    }
+    
+    // Move the dial by rotations [begin, end) without counting anything
+    void advance(const RotationList& rotations, size_t begin, size_t end) {
+        const size_t m = modulus();
+        const int32_t* deltas = rotations.deltas().data();
+        auto overflow = overflow_from(rotations, begin);
+        
+        while (begin < end) {
+            size_t stop = overflow != rotations.overflow().end() ? std::min(overflow->first, end) : end;
+            // Steps are below 2^31, so a 64-bit sum can't overflow
+            uint64_t total = 0;
+            for (size_t i = begin; i < stop; ++i) {
+                total += forward_step(deltas[i], static_cast<uint32_t>(m));
+            }
+            position = (position + total % m) % m;
+            
+            begin = stop;
+            if (begin < end) {
+                add(overflow->second);
+                ++overflow;
+                ++begin;
+            }
+        }
+    }
+
+private:
+    static uint32_t magnitude_of(int32_t delta) {
+        return delta < 0 ? 0u - static_cast<uint32_t>(delta) : static_cast<uint32_t>(delta);
+    }
+    
+    // A delta as the equivalent right turn, in [0, m)
+    static uint32_t forward_step(int32_t delta, uint32_t m) {
+        const uint32_t reduced = magnitude_of(delta) % m;
+        const uint32_t backward = reduced == 0 ? 0 : m - reduced;
+        return delta < 0 ? backward : reduced;
+    }
+    
+    static std::vector<std::pair<size_t, Rotation>>::const_iterator overflow_from(const RotationList& rotations, size_t begin) {
+        return std::lower_bound(rotations.overflow().begin(), rotations.overflow().end(), begin,
+            [](const std::pair<size_t, Rotation>& entry, size_t index) { return entry.first < index; });
+    }
+    
+    size_t modulus_ = T;
 };
 
-// Day 1 main function
-void run_day_1(Answer& answer);
+// Applies the rotations to a Dial<100> starting at `start` and counts zeros. Dial
+// positions add modulo 100, so large inputs are split into chunks and run as a blocked
+// parallel scan on up to `threads` threads (0 = one per core); the result is identical
+// to applying the rotations one by one.
+ZeroCounts count_zeros(const RotationList& rotations, size_t start = 50, size_t threads = 0);
+
+// Single-pass, constant-memory day 1 solver. Input can be fed in arbitrary pieces (a
+// line may be split across them); rotations are parsed byte by byte and applied to the
+// dial as soon as their line ends, so nothing is stored.
+class ZeroCountStream {
+public:
+    explicit ZeroCountStream(size_t start = 50) {
+        dial_.position = start % 100;
+    }
+    
+    void feed(std::string_view bytes);
+    
+    // Apply a last line that has no trailing newline and return the totals
+    ZeroCounts finish();
+
+private:
+    void consume(char c);
+    void end_line();
+    
+    Dial<100> dial_;
+    ZeroCounts counts_;
+    size_t line_ = 1;
+    bool in_line_ = false;
+    bool pending_cr_ = false;
+    Direction direction_ = Direction::Left;
+    uint64_t clicks_ = 0;
+    size_t digits_ = 0;
+};
 
+// Reads `input` in fixed-size blocks through a ZeroCountStream
+ZeroCounts count_zeros_stream(std::istream& input, size_t start = 50);
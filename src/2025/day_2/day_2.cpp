@@ -2,49 +2,230 @@
 // SPDX-License-Identifier: MIT
 
 #include "day_2.h"
-#include <sstream>
+#include "../profile.h"
+#include "../simd.h"
+#include "../thread_pool.h"
+#include <algorithm>
+#include <array>
+#include <iomanip>
 #include <iostream>
+#include <string>
 
 namespace {
 
 const std::string PUZZLE_INPUT_KEY = "day_2";
 
-std::string trim(const std::string& str) {
+// Longest decimal number that fits in 64 bits
+constexpr size_t MAX_DIGITS = 20;
+
+// 10^0 .. 10^19
+constexpr std::array<uint64_t, MAX_DIGITS> POW10 = [] {
+    std::array<uint64_t, MAX_DIGITS> table{};
+    uint64_t value = 1;
+    for (size_t i = 0; i < MAX_DIGITS; ++i) {
+        table[i] = value;
+        value *= 10;
+    }
+    return table;
+}();
+
+constexpr size_t digit_count(uint64_t n) {
+    size_t digits = 1;
+    for (size_t i = 1; i < MAX_DIGITS; ++i) {
+        digits += n >= POW10[i];
+    }
+    return digits;
+}
+
+// 10^(length - period) + ... + 10^period + 1: multiplying a `period`-digit block by it
+// repeats the block to `length` digits (e.g. 6 digits, period 2 -> 10101). Conversely
+// a `length`-digit number repeats a `period`-digit block exactly when it's a multiple.
+constexpr uint64_t block_multiplier(size_t length, size_t period) {
+    uint64_t multiplier = 0;
+    for (size_t shift = 0; shift < length; shift += period) {
+        multiplier += POW10[shift];
+    }
+    return multiplier;
+}
+
+// Block sizes a number of each length can repeat: its proper divisors, ascending
+struct Divisors {
+    size_t count = 0;
+    size_t values[MAX_DIGITS] = {};
+};
+
+constexpr std::array<Divisors, MAX_DIGITS + 1> PROPER_DIVISORS = [] {
+    std::array<Divisors, MAX_DIGITS + 1> table{};
+    for (size_t length = 1; length <= MAX_DIGITS; ++length) {
+        for (size_t period = 1; period < length; ++period) {
+            if (length % period == 0) {
+                table[length].values[table[length].count++] = period;
+            }
+        }
+    }
+    return table;
+}();
+
+// Multipliers for the longest proper periods of each length (length / p for each prime
+// p dividing it). Every shorter period divides one of these, so they're the only ones
+// a validator has to test. Lengths up to 20 have at most two distinct prime factors.
+struct PeriodMultipliers {
+    size_t count = 0;
+    uint64_t values[2] = {};
+};
+
+constexpr std::array<PeriodMultipliers, MAX_DIGITS + 1> MAXIMAL_PERIOD_MULTIPLIERS = [] {
+    std::array<PeriodMultipliers, MAX_DIGITS + 1> table{};
+    for (size_t length = 2; length <= MAX_DIGITS; ++length) {
+        for (size_t prime = 2; prime <= length; ++prime) {
+            bool is_prime = true;
+            for (size_t factor = 2; factor * factor <= prime; ++factor) {
+                is_prime = is_prime && prime % factor != 0;
+            }
+            if (is_prime && length % prime == 0) {
+                table[length].values[table[length].count++] = block_multiplier(length, length / prime);
+            }
+        }
+    }
+    return table;
+}();
+
+// Divisibility by an odd m without dividing: n is a multiple of m exactly when
+// n * m^-1 (mod 2^64) <= (2^64 - 1) / m. Every block multiplier ends in 1, so it's odd.
+struct DivisibilityTest {
+    uint64_t inverse = 0;
+    uint64_t limit = 0;
+    
+    constexpr DivisibilityTest() = default;
+    
+    constexpr explicit DivisibilityTest(uint64_t m) : inverse(m), limit(UINT64_MAX / m) {
+        // Newton's iteration doubles the correct low bits each step; m * m = 1 (mod 8)
+        for (int i = 0; i < 5; ++i) {
+            inverse *= 2 - m * inverse;
+        }
+    }
+    
+    constexpr bool divides(uint64_t n) const {
+        return n * inverse <= limit;
+    }
+};
+
+// The tests that decide both parts for one digit length. tests[0] is the halves
+// multiplier when the length is even, which part 1 uses on its own.
+struct LengthTests {
+    size_t count = 0;
+    bool has_halves = false;
+    DivisibilityTest tests[2];
+};
+
+constexpr std::array<LengthTests, MAX_DIGITS + 1> LENGTH_TESTS = [] {
+    std::array<LengthTests, MAX_DIGITS + 1> table{};
+    for (size_t length = 2; length <= MAX_DIGITS; ++length) {
+        // Primes ascend, so for even lengths the first multiplier is length / 2's
+        const PeriodMultipliers& multipliers = MAXIMAL_PERIOD_MULTIPLIERS[length];
+        table[length].count = multipliers.count;
+        table[length].has_halves = length % 2 == 0;
+        for (size_t i = 0; i < multipliers.count; ++i) {
+            table[length].tests[i] = DivisibilityTest(multipliers.values[i]);
+        }
+    }
+    return table;
+}();
+
+#ifdef AOC_HAVE_AVX2
+// Low 64 bits of a * b per lane; AVX2 only multiplies 32-bit halves
+AOC_TARGET_AVX2 __m256i mullo_epi64(__m256i a, __m256i b) {
+    __m256i low = _mm256_mul_epu32(a, b);
+    __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b),
+                                     _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+    return _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+}
+
+// All ones in the lanes of n the test divides. AVX2 only compares signed, so both
+// sides get their sign bit flipped (biased_limit already is).
+AOC_TARGET_AVX2 __m256i divisible_mask(__m256i n, __m256i inverse, __m256i biased_limit) {
+    const __m256i bias = _mm256_set1_epi64x(INT64_MIN);
+    __m256i product = _mm256_xor_si256(mullo_epi64(n, inverse), bias);
+    return _mm256_xor_si256(_mm256_cmpgt_epi64(product, biased_limit), _mm256_set1_epi64x(-1));
+}
+
+AOC_TARGET_AVX2 uint64_t horizontal_sum(__m256i v) {
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(sum)) + static_cast<uint64_t>(_mm_extract_epi64(sum, 1));
+}
+
+// Four ids per step over [begin, end), all with the digit count `tests` belongs to
+AOC_TARGET_AVX2 InvalidSums sum_invalid_avx2(uint64_t begin, uint64_t end, const LengthTests& tests) {
+    const __m256i bias = _mm256_set1_epi64x(INT64_MIN);
+    __m256i inverses[2];
+    __m256i limits[2];
+    for (size_t i = 0; i < tests.count; ++i) {
+        inverses[i] = _mm256_set1_epi64x(static_cast<int64_t>(tests.tests[i].inverse));
+        limits[i] = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(tests.tests[i].limit)), bias);
+    }
+    
+    __m256i n = _mm256_add_epi64(_mm256_set1_epi64x(static_cast<int64_t>(begin)), _mm256_setr_epi64x(0, 1, 2, 3));
+    const __m256i step = _mm256_set1_epi64x(4);
+    __m256i sum_1 = _mm256_setzero_si256();
+    __m256i sum_2 = _mm256_setzero_si256();
+    
+    uint64_t vector_end = begin + (end - begin) / 4 * 4;
+    for (uint64_t id = begin; id < vector_end; id += 4) {
+        __m256i halves = tests.has_halves ? divisible_mask(n, inverses[0], limits[0]) : _mm256_setzero_si256();
+        __m256i any = halves;
+        for (size_t i = tests.has_halves ? 1 : 0; i < tests.count; ++i) {
+            any = _mm256_or_si256(any, divisible_mask(n, inverses[i], limits[i]));
+        }
+        sum_1 = _mm256_add_epi64(sum_1, _mm256_and_si256(halves, n));
+        sum_2 = _mm256_add_epi64(sum_2, _mm256_and_si256(any, n));
+        n = _mm256_add_epi64(n, step);
+    }
+    
+    InvalidSums sums{horizontal_sum(sum_1), horizontal_sum(sum_2)};
+    for (uint64_t id = vector_end; id < end; ++id) {
+        bool halves = tests.has_halves && tests.tests[0].divides(id);
+        bool any = false;
+        for (size_t i = 0; i < tests.count; ++i) {
+            any = any || tests.tests[i].divides(id);
+        }
+        sums.part_1 += halves ? id : 0;
+        sums.part_2 += any ? id : 0;
+    }
+    return sums;
+}
+#endif
+
+std::string_view trim(std::string_view str) {
     size_t first = str.find_first_not_of(" \t\n\r");
-    if (first == std::string::npos) {
-        return "";
+    if (first == std::string_view::npos) {
+        return {};
     }
     size_t last = str.find_last_not_of(" \t\n\r");
     return str.substr(first, (last - first + 1));
 }
 
 // Parse a single range string "start-end"
-Range parse_range(const std::string& range_str) {
+Range parse_range(std::string_view range_str) {
     size_t dash_pos = range_str.find('-');
-    if (dash_pos == std::string::npos) {
-        throw RisError("Invalid range format: " + range_str);
+    if (dash_pos == std::string_view::npos) {
+        throw RisError("Invalid range format: " + std::string(range_str));
     }
     
-    std::string start_str = range_str.substr(0, dash_pos);
-    std::string end_str = range_str.substr(dash_pos + 1);
-    
-    try {
-        size_t start = std::stoull(start_str);
-        size_t end = std::stoull(end_str) + 1;  // Make end exclusive
-        return Range(start, end);
-    } catch (const std::exception&) {
-        throw RisError("Invalid number in range: " + range_str);
+    RisResult<uint64_t> start = parse_u64(range_str.substr(0, dash_pos));
+    RisResult<uint64_t> end = parse_u64(range_str.substr(dash_pos + 1));
+    if (!start || !end) {
+        throw RisError("Invalid number in range: " + std::string(range_str));
     }
+    
+    return Range(*start, *end + 1);  // Make end exclusive
 }
 
 // Parse all ranges from input string
-std::vector<Range> parse_ranges(const std::string& input) {
+std::vector<Range> parse_ranges(std::string_view input) {
     std::vector<Range> ranges;
-    std::istringstream iss(input);
-    std::string token;
     
-    while (std::getline(iss, token, ',')) {
-        std::string trimmed = trim(token);
+    for (std::string_view token : FieldSplitter(input, ',')) {
+        std::string_view trimmed = trim(token);
         if (!trimmed.empty()) {
             ranges.push_back(parse_range(trimmed));
         }
@@ -55,113 +236,276 @@ std::vector<Range> parse_ranges(const std::string& input) {
 
 size_t run_part_1(const std::vector<Range>& ranges) {
     size_t sum = 0;
-    
     for (const auto& range : ranges) {
-        for (size_t n = range.start; n < range.end; ++n) {
-            if (!NumberValidator1::is_valid(n)) {
-                sum += n;
-            }
-        }
+        sum += sum_repeated_halves(range);
     }
-    
     return sum;
 }
 
 size_t run_part_2(const std::vector<Range>& ranges) {
     size_t sum = 0;
-    
     for (const auto& range : ranges) {
-        for (size_t n = range.start; n < range.end; ++n) {
-            if (!NumberValidator2::is_valid(n)) {
-                sum += n;
-            }
-        }
+        sum += sum_repeated_blocks(range);
     }
-    
     return sum;
 }
 
+// x * multiplier summed over x in [lo, hi], modulo 2^64. One of (hi - lo + 1) and
+// (lo + hi) is even, so halving it first keeps the series exact.
+uint64_t series_sum(uint64_t lo, uint64_t hi, uint64_t multiplier) {
+    uint64_t count = hi - lo + 1;
+    uint64_t ends = lo + hi;
+    if (count % 2 == 0) {
+        count /= 2;
+    } else {
+        ends /= 2;
+    }
+    return count * ends * multiplier;
+}
+
+// Sum of the `length`-digit numbers in [first, last] that repeat a `period`-digit block
+uint64_t sum_with_period(uint64_t first, uint64_t last, size_t length, size_t period) {
+    uint64_t lowest = std::max(first, POW10[length - 1]);
+    uint64_t highest = std::min(last, length == MAX_DIGITS ? UINT64_MAX : POW10[length] - 1);
+    if (lowest > highest) {
+        return 0;
+    }
+    
+    // The matching numbers are exactly block * multiplier for a range of blocks
+    uint64_t multiplier = block_multiplier(length, period);
+    uint64_t block_lo = lowest / multiplier + (lowest % multiplier != 0);
+    uint64_t block_hi = highest / multiplier;
+    if (block_lo > block_hi) {
+        return 0;
+    }
+    return series_sum(block_lo, block_hi, multiplier);
+}
+
 } // anonymous namespace
 
-bool NumberValidator1::is_valid(size_t n) {
-    std::string n_str = std::to_string(n);
-    size_t len = n_str.length();
+uint64_t sum_repeated_halves(const Range& range) {
+    if (range.size() == 0) {
+        return 0;
+    }
     
-    // If length is not even, number is valid
-    if (len % 2 != 0) {
-        return true;
+    uint64_t sum = 0;
+    for (size_t length = 2; length <= MAX_DIGITS; length += 2) {
+        sum += sum_with_period(range.start, range.end - 1, length, length / 2);
+    }
+    return sum;
+}
+
+uint64_t sum_repeated_blocks(const Range& range) {
+    if (range.size() == 0) {
+        return 0;
     }
     
-    // Split into two halves and compare
-    size_t half_len = len / 2;
-    std::string first_half = n_str.substr(0, half_len);
-    std::string second_half = n_str.substr(half_len);
+    uint64_t sum = 0;
+    for (size_t length = 2; length <= MAX_DIGITS; ++length) {
+        // A number with two periods that divide its length also has their gcd as a
+        // period, so counting each number once under its smallest period is
+        // inclusion-exclusion over the divisors: primitive[d] = S(d) - sum of
+        // primitive[e] for e | d, e < d.
+        uint64_t primitive[MAX_DIGITS + 1] = {};
+        const Divisors& periods = PROPER_DIVISORS[length];
+        for (size_t i = 0; i < periods.count; ++i) {
+            size_t period = periods.values[i];
+            primitive[period] = sum_with_period(range.start, range.end - 1, length, period);
+            for (size_t j = 0; j < i; ++j) {
+                if (period % periods.values[j] == 0) {
+                    primitive[period] -= primitive[periods.values[j]];
+                }
+            }
+            sum += primitive[period];
+        }
+    }
+    return sum;
+}
+
+InvalidSums sum_invalid_ids(uint64_t begin, uint64_t end) {
+    InvalidSums sums;
+    while (begin < end) {
+        // Split at powers of ten so every stretch has one digit count
+        size_t length = digit_count(begin);
+        uint64_t stop = length == MAX_DIGITS ? end : std::min(end, POW10[length]);
+        
+#ifdef AOC_HAVE_AVX2
+        if (cpu_has_avx2()) {
+            InvalidSums stretch = sum_invalid_avx2(begin, stop, LENGTH_TESTS[length]);
+            sums.part_1 += stretch.part_1;
+            sums.part_2 += stretch.part_2;
+            begin = stop;
+            continue;
+        }
+#endif
+        InvalidSums stretch = sum_invalid_ids_scalar(begin, stop);
+        sums.part_1 += stretch.part_1;
+        sums.part_2 += stretch.part_2;
+        begin = stop;
+    }
+    return sums;
+}
+
+InvalidSums sum_invalid_ids_scalar(uint64_t begin, uint64_t end) {
+    InvalidSums sums;
+    for (uint64_t n = begin; n < end; ++n) {
+        if (!NumberValidator1::is_valid(n)) {
+            sums.part_1 += n;
+        }
+        if (!NumberValidator2::is_valid(n)) {
+            sums.part_2 += n;
+        }
+    }
+    return sums;
+}
+
+bool repeats_twice_text(uint64_t n) {
+    std::string digits = std::to_string(n);
+    size_t half = digits.size() / 2;
+    return digits.size() % 2 == 0 && digits.compare(0, half, digits, half, half) == 0;
+}
+
+bool repeats_block_text(uint64_t n) {
+    std::string digits = std::to_string(n);
+    size_t len = digits.size();
     
-    // Valid if halves are different
-    return first_half != second_half;
+    // Every block size that divides the length into two or more blocks
+    for (size_t block = 1; block < len; ++block) {
+        if (len % block != 0) {
+            continue;
+        }
+        bool repeated = true;
+        for (size_t pos = block; pos < len && repeated; pos += block) {
+            repeated = digits.compare(pos, block, digits, 0, block) == 0;
+        }
+        if (repeated) {
+            return true;
+        }
+    }
+    return false;
 }
 
-std::vector<size_t> NumberValidator2::find_divisors(size_t len) {
-    std::vector<size_t> divisors;
-    for (size_t i = 1; i < len; ++i) {
-        if (len % i == 0) {
-            divisors.push_back(i);
+InvalidSums sum_invalid_ids_text(uint64_t begin, uint64_t end) {
+    InvalidSums sums;
+    for (uint64_t n = begin; n < end; ++n) {
+        if (repeats_twice_text(n)) {
+            sums.part_1 += n;
+        }
+        if (repeats_block_text(n)) {
+            sums.part_2 += n;
         }
     }
-    return divisors;
+    return sums;
 }
 
-bool NumberValidator2::has_repeating_pattern(const std::string& str, size_t divisor) {
-    size_t elements = str.length() / divisor;
-    if (elements < 2) {
-        return false;
+SweepResult sweep_ranges(const std::vector<Range>& ranges, size_t threads, size_t chunk_size, SweepKernel kernel) {
+    // first_chunk[r] is the index of range r's first chunk
+    std::vector<size_t> first_chunk(ranges.size() + 1, 0);
+    for (size_t r = 0; r < ranges.size(); ++r) {
+        first_chunk[r + 1] = first_chunk[r] + (ranges[r].size() + chunk_size - 1) / chunk_size;
     }
+    size_t chunks = first_chunk.back();
     
-    // Compare adjacent segments
-    for (size_t i = 0; i < elements - 1; ++i) {
-        size_t pos1 = i * divisor;
-        size_t pos2 = (i + 1) * divisor;
+    SweepResult result;
+    result.threads.resize(parallel_worker_count(chunks, threads));
+    parallel_for_workers(chunks, [&](size_t chunk, size_t worker) {
+        // The last range starting at or before this chunk; empty ranges own no chunks
+        size_t r = std::upper_bound(first_chunk.begin(), first_chunk.end(), chunk) - first_chunk.begin() - 1;
+        const Range& range = ranges[r];
+        uint64_t begin = range.start + (chunk - first_chunk[r]) * chunk_size;
+        uint64_t end = begin + std::min<uint64_t>(chunk_size, range.end - begin);
         
-        std::string segment1 = str.substr(pos1, divisor);
-        std::string segment2 = str.substr(pos2, divisor);
+        auto start = std::chrono::steady_clock::now();
+        InvalidSums sums = kernel(begin, end);
         
-        if (segment1 != segment2) {
-            return false;
-        }
-    }
+        SweepThreadStats& stats = result.threads[worker];
+        stats.part_1 += sums.part_1;
+        stats.part_2 += sums.part_2;
+        stats.chunks++;
+        stats.ids += end - begin;
+        stats.busy += std::chrono::steady_clock::now() - start;
+    }, threads);
     
-    return true;
+    for (const auto& stats : result.threads) {
+        result.part_1 += stats.part_1;
+        result.part_2 += stats.part_2;
+    }
+    return result;
+}
+
+bool NumberValidator1::is_valid(size_t n) {
+    // Odd lengths can't split into halves; even ones match exactly when n is a
+    // multiple of 10^(len / 2) + 1
+    size_t len = digit_count(n);
+    return len % 2 != 0 || n % (POW10[len / 2] + 1) != 0;
 }
 
 bool NumberValidator2::is_valid(size_t n) {
-    std::string n_str = std::to_string(n);
-    size_t len = n_str.length();
-    
-    // Find all divisors of the length
-    std::vector<size_t> divisors = find_divisors(len);
-    
-    // Check if any divisor creates a repeating pattern
-    for (size_t divisor : divisors) {
-        if (has_repeating_pattern(n_str, divisor)) {
+    const PeriodMultipliers& multipliers = MAXIMAL_PERIOD_MULTIPLIERS[digit_count(n)];
+    for (size_t i = 0; i < multipliers.count; ++i) {
+        if (n % multipliers.values[i] == 0) {
             return false;  // Invalid if it has a repeating pattern
         }
     }
-    
-    return true;  // Valid if no repeating patterns found
+    return true;
 }
 
-void run_day_2(Answer& answer) {
-    std::cout << "read input..." << std::endl;
-    std::string input = read_puzzle_input(PUZZLE_INPUT_KEY);
+namespace {
+
+class Day2Solution : public DaySolution {
+public:
+    Day2Solution() : DaySolution(PUZZLE_INPUT_KEY) {}
     
-    std::cout << "parse input..." << std::endl;
-    std::vector<Range> ranges = parse_ranges(input);
+    void parse(std::string_view input) override {
+        AOC_SCOPE("day2.parse");
+        ranges_ = parse_ranges(input);
+    }
     
-    std::cout << "run part 1..." << std::endl;
-    size_t result1 = run_part_1(ranges);
-    answer.add("1: " + std::to_string(result1));
+    AnswerValue part_1() const override {
+        AOC_SCOPE("day2.part1");
+        return run_part_1(ranges_);
+    }
     
-    std::cout << "run part 2..." << std::endl;
-    size_t result2 = run_part_2(ranges);
-    answer.add("2: " + std::to_string(result2));
-}
+    AnswerValue part_2() const override {
+        AOC_SCOPE("day2.part2");
+        return run_part_2(ranges_);
+    }
+    
+    // The string checks over every id are the reference. The scalar validators and
+    // the fast brute-force sweep run too and are checked against them, so --verify
+    // covers the enumeration, the validators and (if the CPU has it) the AVX2 kernel.
+    RisResult<std::pair<AnswerValue, AnswerValue>> reference_parts(std::string_view input, std::ostream& log) const override {
+        AOC_SCOPE("day2.reference");
+        std::vector<Range> ranges = parse_ranges(input);
+        SweepResult sweep = sweep_ranges(ranges);
+        SweepResult scalar = sweep_ranges(ranges, 0, 1 << 18, sum_invalid_ids_scalar);
+        SweepResult reference = sweep_ranges(ranges, 0, 1 << 18, sum_invalid_ids_text);
+        
+        // Per-thread shares show how evenly the chunks spread
+        log << std::fixed << std::setprecision(3);
+        for (size_t i = 0; i < sweep.threads.size(); ++i) {
+            const SweepThreadStats& stats = sweep.threads[i];
+            double seconds = std::chrono::duration<double>(stats.busy).count();
+            log << "sweep thread " << i << ": " << stats.chunks << " chunks, " << stats.ids << " ids in "
+                << seconds * 1000 << " ms (" << (seconds > 0 ? stats.ids / seconds / 1e6 : 0.0) << " Mids/s)" << std::endl;
+        }
+        auto check = [&](const char* name, const SweepResult& result) {
+            bool ok = result.part_1 == reference.part_1 && result.part_2 == reference.part_2;
+            log << name << ": " << result.part_1 << ", " << result.part_2 << (ok ? " OK" : " MISMATCH") << std::endl;
+            if (!ok) {
+                throw RisError(std::string(name) + " disagrees with the string checks");
+            }
+        };
+        check("scalar validators", scalar);
+        check("sweep", sweep);
+        
+        return std::make_pair(AnswerValue(reference.part_1), AnswerValue(reference.part_2));
+    }
+
+private:
+    std::vector<Range> ranges_;
+};
+
+AOC_REGISTER_DAY(2, "Gift Shop", Day2Solution);
+
+} // anonymous namespace
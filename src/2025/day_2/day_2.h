@@ -4,6 +4,7 @@
 #pragma once
 
 #include "../common.h"
+#include <chrono>
 #include <string>
 #include <vector>
 
@@ -23,21 +24,70 @@ struct Range {
     }
 };
 
-// Number validator for part 1
+// Sums of the invalid ids in a range, found by enumerating the numbers made of a
+// repeated digit block for each length and block size instead of testing every id, so
+// the cost depends on the digit count rather than the range width. Part 1 counts
+// exactly two copies of a block, part 2 two or more. Sums wrap modulo 2^64, like
+// adding up the ids one by one.
+uint64_t sum_repeated_halves(const Range& range);
+uint64_t sum_repeated_blocks(const Range& range);
+
+// Sums of the ids NumberValidator1 and NumberValidator2 reject
+struct InvalidSums {
+    uint64_t part_1 = 0;
+    uint64_t part_2 = 0;
+};
+
+// Test every id in [begin, end) against both validators. With AVX2, four ids are
+// checked per step as divisibility tests against the repeated-block multipliers
+// (multiply by the modular inverse, compare); without it, the scalar validators run.
+InvalidSums sum_invalid_ids(uint64_t begin, uint64_t end);
+
+// sum_invalid_ids with the scalar validators, whatever the CPU supports
+InvalidSums sum_invalid_ids_scalar(uint64_t begin, uint64_t end);
+
+// The original string checks: format the id and compare its digit blocks. Slow, but they
+// share none of the tables and divisibility tricks above, which makes them the
+// reference --verify checks everything else against.
+bool repeats_twice_text(uint64_t n);
+bool repeats_block_text(uint64_t n);
+
+// sum_invalid_ids with the string checks
+InvalidSums sum_invalid_ids_text(uint64_t begin, uint64_t end);
+
+// One thread's share of a brute-force sweep
+struct SweepThreadStats {
+    uint64_t part_1 = 0;
+    uint64_t part_2 = 0;
+    size_t chunks = 0;
+    uint64_t ids = 0;
+    std::chrono::nanoseconds busy{0};
+};
+
+struct SweepResult {
+    uint64_t part_1 = 0;
+    uint64_t part_2 = 0;
+    std::vector<SweepThreadStats> threads;
+};
+
+// Brute force: test every id of every range with `kernel` (sum_invalid_ids by default).
+// Ranges are cut into chunks of `chunk_size` ids that threads take as they free up, so
+// even one huge range spreads over up to `threads` threads (0 = one per core). Each
+// thread sums into its own slot and the slots are added up at the end.
+using SweepKernel = InvalidSums (*)(uint64_t begin, uint64_t end);
+SweepResult sweep_ranges(const std::vector<Range>& ranges, size_t threads = 0, size_t chunk_size = 1 << 18,
+                         SweepKernel kernel = sum_invalid_ids);
+
+// Number validator for part 1: invalid if the digits are one block repeated twice.
+// Works on the integer alone (no strings, no allocation).
 class NumberValidator1 {
 public:
     static bool is_valid(size_t n);
 };
 
-// Number validator for part 2
+// Number validator for part 2: invalid if the digits are one block repeated two or
+// more times, tested as divisibility by repunit-style multipliers like 1001 or 10101
 class NumberValidator2 {
 public:
     static bool is_valid(size_t n);
-    
-private:
-    static std::vector<size_t> find_divisors(size_t len);
-    static bool has_repeating_pattern(const std::string& str, size_t divisor);
 };
-
-// Day 2 main function
-void run_day_2(Answer& answer);
@@ -2,163 +2,344 @@
 // SPDX-License-Identifier: MIT
 
 #include "day_3.h"
-#include <sstream>
+#include "../profile.h"
+#include "../simd.h"
+#include "../thread_pool.h"
 #include <iostream>
 #include <algorithm>
+#include <cstdint>
 
 namespace {
 
 const std::string PUZZLE_INPUT_KEY = "day_3";
 
+// Below this many input bytes per chunk, threads cost more than they save
+const size_t MIN_CHUNK_BYTES = 1 << 16;
+
 // Parse a single battery character to a value
-size_t parse_battery(char c) {
+uint8_t parse_battery(char c) {
     if (c >= '0' && c <= '9') {
-        return static_cast<size_t>(c - '0');
+        return static_cast<uint8_t>(c - '0');
     }
     throw RisError("Invalid battery: " + std::string(1, c));
 }
 
+// Keeps the largest k-digit subsequence of `digits` in `out`. A digit pops every
+// smaller digit before it off the stack while there are still digits to spare, so
+// the stack stays non-increasing and each digit is pushed and popped at most once.
+void select_max_digits(const uint8_t* digits, size_t count, size_t k, uint8_t* out) {
+    size_t top = 0;
+    size_t spare = count - k;
+    
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t digit = digits[i];
+        while (top > 0 && spare > 0 && out[top - 1] < digit) {
+            --top;
+            --spare;
+        }
+        if (top < k) {
+            out[top++] = digit;
+        } else {
+            --spare;
+        }
+    }
+}
+
+// Largest byte in [data, data + count), stopping as soon as `ceiling` turns up
+uint8_t max_byte_scalar(const uint8_t* data, size_t count, uint8_t ceiling) {
+    uint8_t best = 0;
+    for (size_t i = 0; i < count && best != ceiling; ++i) {
+        best = std::max(best, data[i]);
+    }
+    return best;
+}
+
+#ifdef AOC_HAVE_AVX2
+AOC_TARGET_AVX2 uint8_t horizontal_max(__m256i v) {
+    __m128i m = _mm_max_epu8(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    m = _mm_max_epu8(m, _mm_srli_si128(m, 8));
+    m = _mm_max_epu8(m, _mm_srli_si128(m, 4));
+    m = _mm_max_epu8(m, _mm_srli_si128(m, 2));
+    m = _mm_max_epu8(m, _mm_srli_si128(m, 1));
+    return static_cast<uint8_t>(_mm_cvtsi128_si32(m));
+}
+
+AOC_TARGET_AVX2 uint8_t max_byte_avx2(const uint8_t* data, size_t count, uint8_t ceiling) {
+    const __m256i top = _mm256_set1_epi8(static_cast<char>(ceiling));
+    __m256i best = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, top)) != 0) {
+            return ceiling;
+        }
+        best = _mm256_max_epu8(best, chunk);
+    }
+    return std::max(horizontal_max(best), max_byte_scalar(data + i, count - i, ceiling));
+}
+#endif
+
+uint8_t max_byte(const uint8_t* data, size_t count, uint8_t ceiling) {
+#ifdef AOC_HAVE_AVX2
+    if (cpu_has_avx2()) {
+        return max_byte_avx2(data, count, ceiling);
+    }
+#endif
+    return max_byte_scalar(data, count, ceiling);
+}
+
+void check_bank_size(Bank bank, size_t k) {
+    if (bank.size() < k) {
+        throw RisError("Bank must have at least " + std::to_string(k) + " batteries");
+    }
+}
+
+// Spaces and tabs around a bank are ignored
+std::string_view trim_bank(std::string_view line) {
+    line.remove_prefix(std::min(line.find_first_not_of(" \t"), line.size()));
+    line.remove_suffix(line.size() - (line.find_last_not_of(" \t") + 1));
+    return line;
+}
+
+// The original per-bank algorithms, for --verify
+std::pair<size_t, size_t> run_reference(const BankList& banks) {
+    size_t sum_1 = 0;
+    size_t sum_2 = 0;
+    for (size_t i = 0; i < banks.size(); ++i) {
+        sum_1 += max_joltage_2(banks[i]);
+        sum_2 += max_joltage_12(banks[i]);
+    }
+    return {sum_1, sum_2};
+}
+
+class Day3Solution : public DaySolution {
+public:
+    Day3Solution() : DaySolution(PUZZLE_INPUT_KEY) {}
+    
+    void parse(std::string_view input) override {
+        AOC_SCOPE("day3.parse");
+        banks_ = parse_banks(input);
+    }
+    
+    AnswerValue part_1() const override {
+        AOC_SCOPE("day3.part1");
+        return sum_joltage(banks_, 2);
+    }
+    
+    AnswerValue part_2() const override {
+        AOC_SCOPE("day3.part2");
+        return sum_joltage(banks_, 12);
+    }
+    
+    RisResult<std::pair<AnswerValue, AnswerValue>> reference_parts(std::string_view input, std::ostream& /*log*/) const override {
+        AOC_SCOPE("day3.reference");
+        auto [sum_1, sum_2] = run_reference(parse_banks(input));
+        return std::make_pair(AnswerValue(sum_1), AnswerValue(sum_2));
+    }
+
+private:
+    BankList banks_;
+};
+
+AOC_REGISTER_DAY(3, "Lobby", Day3Solution);
+
+} // anonymous namespace
+
+void BankList::add(std::string_view digits) {
+    size_t start = digits_.size();
+    digits_.resize(start + digits.size());
+    uint8_t* out = digits_.data() + start;
+    
+    // Convert everything branch-free, then go back for the error only if there is one
+    bool invalid = false;
+    for (size_t i = 0; i < digits.size(); ++i) {
+        uint8_t value = static_cast<uint8_t>(digits[i] - '0');
+        invalid |= value > 9;
+        out[i] = value;
+    }
+    if (invalid) {
+        for (char c : digits) {
+            parse_battery(c);
+        }
+    }
+    
+    offsets_.push_back(digits_.size());
+}
+
 // Parse input into banks of batteries
-std::vector<std::vector<size_t>> parse_banks(const std::string& input) {
-    std::vector<std::vector<size_t>> banks;
-    std::istringstream iss(input);
-    std::string line;
+BankList parse_banks(std::string_view input) {
+    BankList banks;
+    // Never more batteries than input bytes, so the digits are allocated once
+    banks.reserve(input.size());
     
-    while (std::getline(iss, line)) {
+    for (std::string_view line : LineSplitter(input)) {
         if (line.empty()) {
             continue;
         }
         
-        line.erase(0, line.find_first_not_of(" \t"));
-        line.erase(line.find_last_not_of(" \t") + 1);
-        
-        std::vector<size_t> bank;
-        for (char c : line) {
-            bank.push_back(parse_battery(c));
-        }
-        banks.push_back(bank);
+        banks.add(trim_bank(line));
     }
     
     return banks;
 }
 
-size_t run_part_1(const std::vector<std::vector<size_t>>& banks) {
-    size_t sum = 0;
+size_t max_joltage_2(Bank bank) {
+    if (bank.size() < 2) {
+        throw RisError("Bank must have at least 2 batteries");
+    }
     
-    for (const auto& bank : banks) {
-        if (bank.size() < 2) {
-            throw RisError("Bank must have at least 2 batteries");
-        }
+    // Go from right to left
+    auto it = bank.rbegin();
+    size_t battery_2 = *it++;
+    size_t battery_1 = *it++;
+    
+    for (; it != bank.rend(); ++it) {
+        size_t battery = *it;
         
-        // Go from right to left
-        auto it = bank.rbegin();
-        size_t battery_2 = *it++;
-        size_t battery_1 = *it++;
+        if (battery < battery_1) {
+            continue;
+        }
         
-        for (; it != bank.rend(); ++it) {
-            size_t battery = *it;
-            
-            if (battery < battery_1) {
-                continue;
-            }
-            
-            if (battery_1 >= battery_2) {
-                battery_2 = battery_1;
-            }
-            
-            battery_1 = battery;
+        if (battery_1 >= battery_2) {
+            battery_2 = battery_1;
         }
         
-        size_t joltage = battery_1 * 10 + battery_2;
-        sum += joltage;
+        battery_1 = battery;
+    }
+    
+    return battery_1 * 10 + battery_2;
+}
+
+size_t max_joltage_2_scan(std::span<const uint8_t> bytes, uint8_t zero) {
+    if (bytes.size() < 2) {
+        throw RisError("Bank must have at least 2 batteries");
     }
     
-    return sum;
+    const uint8_t* data = bytes.data();
+    const uint8_t nine = static_cast<uint8_t>(zero + 9);
+    
+    // Tens digit: the leftmost maximum, leaving at least one battery after it
+    uint8_t first = max_byte(data, bytes.size() - 1, nine);
+    const char* begin = reinterpret_cast<const char*>(data);
+    size_t position = static_cast<size_t>(find_char(begin, begin + bytes.size() - 1, static_cast<char>(first)) - begin);
+    
+    // Units digit: the maximum of everything after it
+    uint8_t second = max_byte(data + position + 1, bytes.size() - position - 1, nine);
+    
+    return static_cast<size_t>(first - zero) * 10 + static_cast<size_t>(second - zero);
 }
 
-size_t run_part_2(const std::vector<std::vector<size_t>>& banks) {
-    size_t sum = 0;
+size_t max_joltage_12(Bank bank) {
     const size_t CAPACITY = 12;
     
-    for (const auto& bank : banks) {
-        if (bank.size() < CAPACITY) {
-            throw RisError("Bank must have at least " + std::to_string(CAPACITY) + " batteries");
-        }
-        
-        // Produce initial state of batteries (last 12 from right to left, then reversed)
-        std::vector<size_t> batteries;
-        batteries.reserve(CAPACITY);
+    if (bank.size() < CAPACITY) {
+        throw RisError("Bank must have at least " + std::to_string(CAPACITY) + " batteries");
+    }
+    
+    // Produce initial state of batteries (last 12 from right to left, then reversed)
+    std::vector<size_t> batteries;
+    batteries.reserve(CAPACITY);
+    
+    auto it = bank.rbegin();
+    for (size_t i = 0; i < CAPACITY; ++i) {
+        batteries.push_back(*it++);
+    }
+    std::reverse(batteries.begin(), batteries.end());
+    
+    // Process remaining batteries
+    for (; it != bank.rend(); ++it) {
+        size_t battery = *it;
         
-        auto it = bank.rbegin();
-        for (size_t i = 0; i < CAPACITY; ++i) {
-            batteries.push_back(*it++);
+        if (battery < batteries[0]) {
+            // No ripple required, no higher joltage can be produced
+            continue;
         }
-        std::reverse(batteries.begin(), batteries.end());
         
-        // Process remaining batteries
-        for (; it != bank.rend(); ++it) {
-            size_t battery = *it;
-            
-            if (battery < batteries[0]) {
-                // No ripple required, no higher joltage can be produced
-                continue;
-            }
-            
-            // Produce ripple
-            std::vector<size_t> new_batteries;
-            new_batteries.reserve(CAPACITY);
-            new_batteries.push_back(battery);
-            
-            // Ripple effect
-            for (size_t i = new_batteries.size(); i < CAPACITY; ++i) {
-                size_t i1 = i - 1;
-                size_t i2 = i;
-                
-                if (batteries[i1] >= batteries[i2]) {
-                    new_batteries.push_back(batteries[i1]);
-                } else {
-                    break;
-                }
-            }
+        // Produce ripple
+        std::vector<size_t> new_batteries;
+        new_batteries.reserve(CAPACITY);
+        new_batteries.push_back(battery);
+        
+        // Ripple effect
+        for (size_t i = new_batteries.size(); i < CAPACITY; ++i) {
+            size_t i1 = i - 1;
+            size_t i2 = i;
             
-            // Fill with remaining batteries
-            for (size_t i = new_batteries.size(); i < CAPACITY; ++i) {
-                new_batteries.push_back(batteries[i]);
+            if (batteries[i1] >= batteries[i2]) {
+                new_batteries.push_back(batteries[i1]);
+            } else {
+                break;
             }
-            
-            // Apply new state
-            batteries = new_batteries;
         }
         
-        // Calculate joltage
-        size_t joltage = 0;
-        size_t power = 1;
-        for (auto it = batteries.rbegin(); it != batteries.rend(); ++it) {
-            joltage += *it * power;
-            power *= 10;
+        // Fill with remaining batteries
+        for (size_t i = new_batteries.size(); i < CAPACITY; ++i) {
+            new_batteries.push_back(batteries[i]);
         }
         
-        sum += joltage;
+        // Apply new state
+        batteries = new_batteries;
     }
     
-    return sum;
+    // Calculate joltage
+    size_t joltage = 0;
+    size_t power = 1;
+    for (auto it = batteries.rbegin(); it != batteries.rend(); ++it) {
+        joltage += *it * power;
+        power *= 10;
+    }
+    
+    return joltage;
 }
 
-} // anonymous namespace
+size_t max_joltage(std::span<const uint8_t> bytes, size_t k) {
+    if (k > MAX_JOLTAGE_DIGITS) {
+        throw RisError("Joltage of " + std::to_string(k) + " batteries doesn't fit in 64 bits");
+    }
+    check_bank_size(bytes, k);
+    
+    uint8_t digits[MAX_JOLTAGE_DIGITS];
+    select_max_digits(bytes.data(), bytes.size(), k, digits);
+    
+    size_t joltage = 0;
+    for (size_t i = 0; i < k; ++i) {
+        joltage = joltage * 10 + digits[i];
+    }
+    return joltage;
+}
 
-void run_day_3(Answer& answer) {
-    std::cout << "read input..." << std::endl;
-    std::string input = read_puzzle_input(PUZZLE_INPUT_KEY);
+size_t sum_joltage(const BankList& banks, size_t k, size_t threads) {
+    if (threads == 0) {
+        threads = compute_pool().size();
+    }
     
-    std::cout << "parse input..." << std::endl;
-    std::vector<std::vector<size_t>> banks = parse_banks(input);
+    // A few runs of banks per thread, so uneven banks still balance
+    size_t chunks = std::clamp<size_t>(banks.batteries() / MIN_CHUNK_BYTES, 1, threads * 4);
+    chunks = std::min(chunks, std::max<size_t>(banks.size(), 1));
     
-    std::cout << "run part 1..." << std::endl;
-    size_t result1 = run_part_1(banks);
-    answer.add("1: " + std::to_string(result1));
+    std::vector<size_t> sums(chunks, 0);
+    parallel_for(chunks, [&](size_t chunk) {
+        size_t end = banks.size() * (chunk + 1) / chunks;
+        for (size_t i = banks.size() * chunk / chunks; i < end; ++i) {
+            sums[chunk] += k == 2 ? max_joltage_2_scan(banks[i]) : max_joltage(banks[i], k);
+        }
+    }, threads);
     
-    std::cout << "run part 2..." << std::endl;
-    size_t result2 = run_part_2(banks);
-    answer.add("2: " + std::to_string(result2));
+    size_t total = 0;
+    for (size_t sum : sums) {
+        total += sum;
+    }
+    return total;
 }
 
+std::string max_joltage_string(Bank bank, size_t k) {
+    check_bank_size(bank, k);
+    
+    // The string doubles as the stack, then its digits become characters in place
+    std::string joltage(k, '\0');
+    select_max_digits(bank.data(), bank.size(), k, reinterpret_cast<uint8_t*>(joltage.data()));
+    for (char& c : joltage) {
+        c = static_cast<char>('0' + c);
+    }
+    return joltage;
+}
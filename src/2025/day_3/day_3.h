@@ -4,9 +4,73 @@
 #pragma once
 
 #include "../common.h"
+#include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
-// Day 3 main function
-void run_day_3(Answer& answer);
+// One bank of batteries, one digit value (0-9) per byte
+using Bank = std::span<const uint8_t>;
 
+// Every bank's digits back to back in one buffer, with bank i spanning
+// [offsets[i], offsets[i + 1]) (CSR layout): one byte per battery and two allocations
+// in total, however many banks there are.
+class BankList {
+public:
+    BankList() : offsets_{0} {}
+    
+    void reserve(size_t batteries) {
+        digits_.reserve(batteries);
+    }
+    
+    // Append a bank from its ASCII digits
+    void add(std::string_view digits);
+    
+    size_t size() const {
+        return offsets_.size() - 1;
+    }
+    
+    size_t batteries() const {
+        return digits_.size();
+    }
+    
+    Bank operator[](size_t i) const {
+        return Bank(digits_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+    }
+
+private:
+    std::vector<uint8_t> digits_;
+    std::vector<size_t> offsets_;
+};
+
+// Parse input into banks of batteries, one digit per battery
+BankList parse_banks(std::string_view input);
+
+// Highest joltage from turning on exactly 2 batteries of a bank
+size_t max_joltage_2(Bank bank);
+
+// max_joltage_2 as two vectorized scans (32 batteries per step with AVX2, scalar
+// otherwise): the leftmost maximum of all but the last battery, then the maximum after
+// it, each stopping early at a 9. Only byte order matters, so it runs on digit values
+// or straight on ASCII digits; `zero` is the byte that means 0.
+size_t max_joltage_2_scan(std::span<const uint8_t> bytes, uint8_t zero = 0);
+
+// Highest joltage from turning on exactly 12 batteries of a bank, rippling a 12-digit
+// window through the bank. Kept as the reference for max_joltage(bank, 12).
+size_t max_joltage_12(Bank bank);
+
+// Most digits a joltage can have and still fit in 64 bits
+const size_t MAX_JOLTAGE_DIGITS = 19;
+
+// Highest joltage from turning on exactly `k` batteries (k <= MAX_JOLTAGE_DIGITS). A
+// monotonic stack picks the digits in one O(n) pass, without allocating.
+size_t max_joltage(std::span<const uint8_t> bytes, size_t k);
+
+// The same for any k, as a decimal string
+std::string max_joltage_string(Bank bank, size_t k);
+
+// Sum of the best k-battery joltage of every bank (max_joltage_2_scan for k = 2,
+// max_joltage otherwise), over runs of banks in parallel on up to `threads` threads
+// (0 = one per core)
+size_t sum_joltage(const BankList& banks, size_t k, size_t threads = 0);
@@ -4,9 +4,184 @@
 #pragma once
 
 #include "../common.h"
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
-// Day 4 main function
-void run_day_4(Answer& answer);
+// Grid structure to represent the paper roll locations
+class PaperGrid {
+public:
+    PaperGrid(std::vector<std::string> lines) : grid_(std::move(lines)) {
+        if (grid_.empty()) {
+            throw RisError("Grid cannot be empty");
+        }
+        height_ = grid_.size();
+        width_ = grid_[0].size();
+        
+        // Validate all rows have the same width
+        for (size_t i = 0; i < grid_.size(); ++i) {
+            if (grid_[i].length() != width_) {
+                throw RisError("Grid rows must have consistent width");
+            }
+        }
+    }
+    
+    bool is_roll(size_t row, size_t col) const {
+        if (row >= height_ || col >= width_) {
+            return false;
+        }
+        return grid_[row][col] == '@';
+    }
+    
+    size_t count_adjacent_rolls(size_t row, size_t col) const {
+        size_t count = 0;
+        
+        // Check all 8 adjacent positions
+        for (int dr = -1; dr <= 1; ++dr) {
+            for (int dc = -1; dc <= 1; ++dc) {
+                if (dr == 0 && dc == 0) {
+                    continue; // Skip the center position
+                }
+                
+                int new_row = static_cast<int>(row) + dr;
+                int new_col = static_cast<int>(col) + dc;
+                
+                if (new_row >= 0 && new_row < static_cast<int>(height_) &&
+                    new_col >= 0 && new_col < static_cast<int>(width_)) {
+                    if (is_roll(static_cast<size_t>(new_row), static_cast<size_t>(new_col))) {
+                        count++;
+                    }
+                }
+            }
+        }
+        
+        return count;
+    }
+    
+    bool is_accessible(size_t row, size_t col) const {
+        if (!is_roll(row, col)) {
+            return false;
+        }
+        return count_adjacent_rolls(row, col) < 4;
+    }
+    
+    size_t get_height() const { return height_; }
+    size_t get_width() const { return width_; }
 
+private:
+    std::vector<std::string> grid_;
+    size_t height_;
+    size_t width_;
+};
+
+// The grid packed one bit per cell, 64 cells to a word, each row padded to whole words
+// with the padding bits kept clear. Neighbor counts then work on 64 cells at once.
+class RollBitboard {
+public:
+    explicit RollBitboard(const PaperGrid& grid);
+    
+    // From packed rows already in this layout; bits past `width` are cleared
+    RollBitboard(size_t height, size_t width, std::vector<uint64_t> bits);
+    
+    size_t height() const { return height_; }
+    size_t width() const { return width_; }
+    size_t words_per_row() const { return words_; }
+    
+    bool is_roll(size_t row, size_t col) const {
+        return (bits_[row * words_ + col / 64] >> (col % 64)) & 1;
+    }
+    
+    // Rolls with fewer than 4 rolls among their 8 neighbors, one bit per cell in the
+    // same layout. The neighbors of a word come from shifted words of the rows around
+    // it, added up with bit-sliced adders.
+    void accessible(std::vector<uint64_t>& mask) const;
+    
+    // How many rolls in rows [row_begin, row_end) are accessible
+    size_t count_accessible(size_t row_begin, size_t row_end) const;
+    
+    // Writes rows [row_begin, row_end) of `next` as this board after one round of
+    // removals, returning how many rolls those rows lost. `next` must be the same size.
+    size_t remove_accessible(RollBitboard& next, size_t row_begin, size_t row_end) const;
+    
+    // Clear every roll set in `mask`, returning how many there were
+    size_t remove(const std::vector<uint64_t>& mask);
+    
+    size_t count() const;
+
+private:
+    // Runs the stencil over rows [row_begin, row_end), calling out(index, word, crowded)
+    // for every word. The rows just outside the range are read but never written, so
+    // disjoint ranges can run side by side.
+    template<typename F>
+    void stencil_rows(size_t row_begin, size_t row_end, F&& out) const;
+    
+    size_t height_;
+    size_t width_;
+    size_t words_;
+    std::vector<uint64_t> bits_;
+    std::vector<uint64_t> empty_row_;  // stands in for the rows above and below the grid
+};
+
+// Part 1 over bands of `band_rows` rows on up to `threads` threads (0 = one per core)
+size_t count_accessible(const RollBitboard& board, size_t threads = 0, size_t band_rows = 0);
+
+// The bitboard stencil split into bands of rows that run in parallel. Each band reads a
+// one-row halo on either side from the current board and writes only its own rows of
+// the next one; the boards swap after every round, so a round sees exactly the state
+// at its start, the same as the serial version. Zero band rows picks a size that keeps
+// a band's words in L2.
+class TiledStencil {
+public:
+    explicit TiledStencil(RollBitboard board, size_t threads = 0, size_t band_rows = 0);
+    
+    size_t band_rows() const { return band_rows_; }
+    size_t bands() const { return removed_.size(); }
+    const RollBitboard& board() const { return current_; }
+    
+    size_t count_accessible() const;
+    
+    // One synchronous round: every roll accessible at its start goes. Returns how many.
+    size_t remove_round();
+    
+    // Rounds until one removes nothing, returning the total removed
+    size_t remove_all();
+
+private:
+    RollBitboard current_;
+    RollBitboard next_;
+    size_t threads_;
+    size_t band_rows_;
+    std::vector<size_t> removed_;  // per band, for the round in progress
+};
+
+// Part 2 the direct way: synchronous rounds on a TiledStencil until a round removes
+// nothing. Returns the rolls removed.
+size_t remove_in_rounds(RollBitboard board, size_t threads = 0, size_t band_rows = 0);
+
+struct PeelResult {
+    size_t removed = 0;
+    size_t rounds = 0;
+    // Per cell, row-major: the round that removed it, or 0 if it's never removed (or
+    // was never a roll)
+    std::vector<uint32_t> removal_round;
+};
+
+// Largest grid part 2 peels. peel_rolls keeps 10 bytes per cell (alive flag, neighbor
+// count, removal round, and a 4-byte queue slot per roll), so about 640 MiB here,
+// against 2 bits per cell for the tiled rounds.
+const size_t PEEL_MAX_CELLS = size_t{1} << 26;
+
+// Part 2 as k-core peeling: neighbor counts are computed once, accessible rolls go on a
+// worklist, and removing one only decrements its 8 neighbors, queuing those that drop
+// below 4 for the next round. O(cells) in total rather than a full pass per round,
+// with the same rounds as remove_in_rounds.
+PeelResult peel_rolls(const RollBitboard& board);
+
+// Parse input into a grid, one string per row. Only the --verify reference uses it.
+PaperGrid parse_grid(std::string_view input);
+
+// Parse input straight into a bitboard, packing each row of the view as it's read
+// without copying the text
+RollBitboard parse_board(std::string_view input);
@@ -2,9 +2,9 @@
 // SPDX-License-Identifier: MIT
 
 #include "day_5.h"
+#include "../profile.h"
 #include <algorithm>
 #include <iostream>
-#include <sstream>
 #include <string>
 #include <vector>
 
@@ -12,39 +12,35 @@ namespace {
 
 const std::string PUZZLE_INPUT_KEY = "day_5";
 
-struct Range {
-    size_t start;
-    size_t end; // inclusive
-};
-
-Range parse_range(const std::string& line) {
+FreshRange parse_range(std::string_view line) {
     size_t dash_pos = line.find('-');
-    if (dash_pos == std::string::npos) {
-        throw RisError("Invalid range line: " + line);
+    if (dash_pos == std::string_view::npos) {
+        throw RisError("Invalid range line: " + std::string(line));
     }
 
-    size_t start = std::stoull(line.substr(0, dash_pos));
-    size_t end = std::stoull(line.substr(dash_pos + 1));
+    RisResult<uint64_t> start = parse_u64(line.substr(0, dash_pos));
+    RisResult<uint64_t> end = parse_u64(line.substr(dash_pos + 1));
+    if (!start || !end) {
+        throw RisError("Invalid number in range line: " + std::string(line));
+    }
 
-    if (end < start) {
-        throw RisError("Range end before start: " + line);
+    if (*end < *start) {
+        throw RisError("Range end before start: " + std::string(line));
     }
 
-    return Range{start, end};
+    return FreshRange{*start, *end};
 }
 
 struct InputData {
-    std::vector<Range> ranges;
+    std::vector<FreshRange> ranges;
     std::vector<size_t> ids;
 };
 
-InputData parse_input(const std::string& input) {
+InputData parse_input(std::string_view input) {
     InputData data;
-    std::istringstream iss(input);
-    std::string line;
     bool reading_ranges = true;
 
-    while (std::getline(iss, line)) {
+    for (std::string_view line : LineSplitter(input)) {
         if (line.empty()) {
             reading_ranges = false;
             continue;
@@ -53,31 +49,88 @@ InputData parse_input(const std::string& input) {
         if (reading_ranges) {
             data.ranges.push_back(parse_range(line));
         } else {
-            data.ids.push_back(std::stoull(line));
+            RisResult<uint64_t> id = parse_u64(line);
+            if (!id) {
+                throw RisError("Invalid ingredient id: " + std::string(line));
+            }
+            data.ids.push_back(*id);
         }
     }
 
     return data;
 }
 
-std::vector<Range> merge_ranges(std::vector<Range> ranges) {
+size_t run_part_1(const std::vector<FreshRange>& merged_ranges, const std::vector<size_t>& ids) {
+    size_t fresh_count = 0;
+
+    for (size_t id : ids) {
+        if (contains(merged_ranges, id)) {
+            ++fresh_count;
+        }
+    }
+
+    return fresh_count;
+}
+
+size_t run_part_2(const std::vector<FreshRange>& merged_ranges) {
+    size_t total = 0;
+    for (const auto& r : merged_ranges) {
+        total += (r.end - r.start + 1);
+    }
+    return total;
+}
+
+class Day5Solution : public DaySolution {
+public:
+    Day5Solution() : DaySolution(PUZZLE_INPUT_KEY) {}
+
+    void parse(std::string_view input) override {
+        {
+            AOC_SCOPE("day5.parse");
+            data_ = parse_input(input);
+        }
+        
+        AOC_SCOPE("day5.merge_ranges");
+        merged_ranges_ = merge_ranges(data_.ranges);
+    }
+
+    AnswerValue part_1() const override {
+        AOC_SCOPE("day5.part1");
+        return run_part_1(merged_ranges_, data_.ids);
+    }
+
+    AnswerValue part_2() const override {
+        AOC_SCOPE("day5.part2");
+        return run_part_2(merged_ranges_);
+    }
+
+private:
+    InputData data_;
+    std::vector<FreshRange> merged_ranges_;
+};
+
+AOC_REGISTER_DAY(5, "Cafeteria", Day5Solution);
+
+} // anonymous namespace
+
+std::vector<FreshRange> merge_ranges(std::vector<FreshRange> ranges) {
     if (ranges.empty()) {
         return {};
     }
 
-    std::sort(ranges.begin(), ranges.end(), [](const Range& a, const Range& b) {
+    std::sort(ranges.begin(), ranges.end(), [](const FreshRange& a, const FreshRange& b) {
         if (a.start == b.start) {
             return a.end < b.end;
         }
         return a.start < b.start;
     });
 
-    std::vector<Range> merged;
+    std::vector<FreshRange> merged;
     merged.push_back(ranges.front());
 
     for (size_t i = 1; i < ranges.size(); ++i) {
-        Range& current = merged.back();
-        const Range& next = ranges[i];
+        FreshRange& current = merged.back();
+        const FreshRange& next = ranges[i];
 
         if (next.start <= current.end + 1) {
             current.end = std::max(current.end, next.end);
@@ -89,10 +142,10 @@ std::vector<Range> merge_ranges(std::vector<Range> ranges) {
     return merged;
 }
 
-bool contains(const std::vector<Range>& merged_ranges, size_t value) {
+bool contains(const std::vector<FreshRange>& merged_ranges, size_t value) {
     auto it = std::upper_bound(
         merged_ranges.begin(), merged_ranges.end(), value,
-        [](size_t val, const Range& range) { return val < range.start; });
+        [](size_t val, const FreshRange& range) { return val < range.start; });
 
     if (it == merged_ranges.begin()) {
         return false;
@@ -101,43 +154,3 @@ bool contains(const std::vector<Range>& merged_ranges, size_t value) {
     --it;
     return value <= it->end;
 }
-
-size_t run_part_1(const std::vector<Range>& merged_ranges, const std::vector<size_t>& ids) {
-    size_t fresh_count = 0;
-
-    for (size_t id : ids) {
-        if (contains(merged_ranges, id)) {
-            ++fresh_count;
-        }
-    }
-
-    return fresh_count;
-}
-
-size_t run_part_2(const std::vector<Range>& merged_ranges) {
-    size_t total = 0;
-    for (const auto& r : merged_ranges) {
-        total += (r.end - r.start + 1);
-    }
-    return total;
-}
-
-} // anonymous namespace
-
-void run_day_5(Answer& answer) {
-    std::cout << "read input..." << std::endl;
-    std::string input = read_puzzle_input(PUZZLE_INPUT_KEY);
-
-    std::cout << "parse input..." << std::endl;
-    InputData data = parse_input(input);
-    std::vector<Range> merged_ranges = merge_ranges(data.ranges);
-
-    std::cout << "run part 1..." << std::endl;
-    size_t result1 = run_part_1(merged_ranges, data.ids);
-    answer.add("1: " + std::to_string(result1));
-
-    std::cout << "run part 2..." << std::endl;
-    size_t result2 = run_part_2(merged_ranges);
-    answer.add("2: " + std::to_string(result2));
-}
-
@@ -7,6 +7,14 @@
 #include <string>
 #include <vector>
 
-// Day 5 main function
-void run_day_5(Answer& answer);
+// Range of fresh ingredient ids
+struct FreshRange {
+    size_t start;
+    size_t end; // inclusive
+};
 
+// Sort ranges and merge the ones that overlap or touch
+std::vector<FreshRange> merge_ranges(std::vector<FreshRange> ranges);
+
+// Binary search for `value` in ranges produced by merge_ranges
+bool contains(const std::vector<FreshRange>& merged_ranges, size_t value);
@@ -0,0 +1,253 @@
+// SPDX-FileCopyrightText: 2025 SternXD
+// SPDX-License-Identifier: MIT
+
+#include "driver.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Nanoseconds = std::chrono::nanoseconds;
+
+struct PhaseStats {
+    Nanoseconds min;
+    Nanoseconds median;
+    Nanoseconds p99;
+};
+
+// Nearest-rank percentile over sorted samples
+Nanoseconds percentile(const std::vector<Nanoseconds>& sorted, size_t percent) {
+    size_t rank = (sorted.size() * percent + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+PhaseStats summarize(std::vector<Nanoseconds> samples) {
+    std::sort(samples.begin(), samples.end());
+    return PhaseStats{samples.front(), percentile(samples, 50), percentile(samples, 99)};
+}
+
+template<typename F>
+Nanoseconds time_phase(F&& phase) {
+    auto start = Clock::now();
+    phase();
+    return std::chrono::duration_cast<Nanoseconds>(Clock::now() - start);
+}
+
+void print_phase(const char* name, const std::vector<Nanoseconds>& samples, bool last) {
+    PhaseStats stats = summarize(samples);
+    std::cout << "    \"" << name << "\": {"
+              << "\"min_ns\": " << stats.min.count() << ", "
+              << "\"median_ns\": " << stats.median.count() << ", "
+              << "\"p99_ns\": " << stats.p99.count() << "}"
+              << (last ? "" : ",") << std::endl;
+}
+
+// Everything a day produced while running on a worker thread
+struct DayReport {
+    explicit DayReport(Answer answer) : answer(std::move(answer)) {}
+    
+    Answer answer;
+    std::string log;
+    std::string error;
+    Nanoseconds elapsed{0};
+};
+
+DayReport run_day_buffered(const DayInfo& day) {
+    DayReport report{Answer(day.day)};
+    std::ostringstream log;
+    
+    auto start = Clock::now();
+    try {
+        std::unique_ptr<DaySolution> solution = day.create();
+        run_solution(*solution, report.answer, log);
+    } catch (const RisError& e) {
+        report.error = std::string("Error: ") + e.what();
+    } catch (const std::exception& e) {
+        report.error = std::string("Unexpected error: ") + e.what();
+    }
+    report.elapsed = std::chrono::duration_cast<Nanoseconds>(Clock::now() - start);
+    report.log = log.str();
+    
+    return report;
+}
+
+double to_milliseconds(Nanoseconds duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // anonymous namespace
+
+void run_bench(const DayInfo& day, size_t iterations) {
+    if (iterations == 0) {
+        throw RisError("Benchmark needs at least one iteration");
+    }
+    
+    std::vector<Nanoseconds> read_samples, parse_samples, part1_samples, part2_samples;
+    AnswerValue result1;
+    AnswerValue result2;
+    
+    for (size_t i = 0; i < iterations; ++i) {
+        // Fresh solution every iteration so no parsed state carries over
+        std::unique_ptr<DaySolution> solution = day.create();
+        std::optional<MappedInput> input;
+        
+        read_samples.push_back(time_phase([&] {
+            input.emplace(map_puzzle_input(solution->input_key()));
+            input->prefault();
+        }));
+        parse_samples.push_back(time_phase([&] { solution->parse(input->view()); }));
+        part1_samples.push_back(time_phase([&] { result1 = solution->part_1(); }));
+        part2_samples.push_back(time_phase([&] { result2 = solution->part_2(); }));
+    }
+    
+    std::cout << "{" << std::endl;
+    std::cout << "  \"day\": " << day.day << "," << std::endl;
+    std::cout << "  \"title\": ";
+    write_json_string(std::cout, day.title);
+    std::cout << "," << std::endl;
+    std::cout << "  \"iterations\": " << iterations << "," << std::endl;
+    std::cout << "  \"answers\": [";
+    write_json_value(std::cout, result1);
+    std::cout << ", ";
+    write_json_value(std::cout, result2);
+    std::cout << "]," << std::endl;
+    std::cout << "  \"phases\": {" << std::endl;
+    print_phase("read", read_samples, false);
+    print_phase("parse", parse_samples, false);
+    print_phase("part_1", part1_samples, false);
+    print_phase("part_2", part2_samples, true);
+    std::cout << "  }" << std::endl;
+    std::cout << "}" << std::endl;
+}
+
+void run_stream(const DayInfo& day, std::istream& input, Answer& answer, std::ostream& log) {
+    std::unique_ptr<DaySolution> solution = day.create();
+    log << "stream input..." << std::endl;
+    
+    reset_peak_allocated_bytes();
+    auto start = Clock::now();
+    RisResult<std::pair<AnswerValue, AnswerValue>> results = solution->solve_stream(input);
+    Nanoseconds elapsed = std::chrono::duration_cast<Nanoseconds>(Clock::now() - start);
+    size_t peak = peak_allocated_bytes();
+    
+    if (!results) {
+        throw RisError("Day " + std::to_string(day.day) + " can't be solved from a stream");
+    }
+    
+    // Both parts come out of the same pass, so its cost is booked on part 1
+    answer.add(std::move(results->first), elapsed, peak);
+    answer.add(std::move(results->second));
+}
+
+int run_verify(const DayInfo& day, std::ostream& out) {
+    std::unique_ptr<DaySolution> solution = day.create();
+    Answer answer(day.day);
+    run_solution(*solution, answer, out);
+    
+    out << "run reference..." << std::endl;
+    MappedInput input = map_puzzle_input(solution->input_key());
+    auto start = Clock::now();
+    RisResult<std::pair<AnswerValue, AnswerValue>> reference = solution->reference_parts(input.view(), out);
+    Nanoseconds elapsed = std::chrono::duration_cast<Nanoseconds>(Clock::now() - start);
+    if (!reference) {
+        throw RisError("Day " + std::to_string(day.day) + " has no reference path to verify against");
+    }
+    
+    const AnswerValue expected[] = {reference->first, reference->second};
+    bool ok = true;
+    out << std::fixed << std::setprecision(3);
+    for (const PartResult& result : answer.get_results()) {
+        const AnswerValue& want = expected[result.part - 1];
+        bool match = result.value == want;
+        ok = ok && match;
+        out << result.part << ": " << to_string(result.value) << " (" << to_milliseconds(result.elapsed) << " ms), "
+            << "reference " << to_string(want) << (match ? " OK" : " MISMATCH") << std::endl;
+    }
+    out << "reference time: " << to_milliseconds(elapsed) << " ms" << std::endl;
+    
+    return ok ? 0 : 1;
+}
+
+int run_all(const std::map<int, DayInfo>& days, size_t threads, OutputFormat format) {
+    auto start = Clock::now();
+    ThreadPool pool(threads);
+    
+    std::vector<std::future<DayReport>> pending;
+    for (const auto& entry : days) {
+        const DayInfo& day = entry.second;
+        pending.push_back(pool.submit([&day] { return run_day_buffered(day); }));
+    }
+    
+    // Each day buffers its own output, so printing in map order keeps days apart
+    bool failed = false;
+    std::vector<std::pair<int, Nanoseconds>> day_times;
+    std::cout << std::fixed << std::setprecision(3);
+    if (format == OutputFormat::Csv) {
+        Answer::print_csv_header(std::cout);
+    }
+    
+    for (auto& future : pending) {
+        DayReport report = future.get();
+        int day_num = report.answer.day();
+        bool day_failed = !report.error.empty();
+        failed = failed || day_failed;
+        day_times.emplace_back(day_num, report.elapsed);
+        
+        switch (format) {
+            case OutputFormat::Text:
+                std::cout << "=== Day " << day_num << " ===" << std::endl;
+                std::cout << report.log;
+                report.answer.print(std::cout);
+                if (day_failed) {
+                    std::cout << report.error << std::endl;
+                }
+                std::cout << "time: " << to_milliseconds(report.elapsed) << " ms" << std::endl;
+                break;
+            case OutputFormat::Json:
+                // One JSON object per line
+                if (day_failed) {
+                    std::cout << "{\"day\": " << day_num << ", \"error\": ";
+                    write_json_string(std::cout, report.error);
+                    std::cout << "}" << std::endl;
+                } else {
+                    report.answer.print_json(std::cout);
+                }
+                break;
+            case OutputFormat::Csv:
+                report.answer.print_csv(std::cout);
+                if (day_failed) {
+                    std::cerr << "Day " << day_num << ": " << report.error << std::endl;
+                }
+                break;
+        }
+    }
+    
+    Nanoseconds total = std::chrono::duration_cast<Nanoseconds>(Clock::now() - start);
+    switch (format) {
+        case OutputFormat::Text:
+            std::cout << "=== Total ===" << std::endl;
+            std::cout << days.size() << " days on " << pool.size() << " threads in "
+                      << to_milliseconds(total) << " ms" << std::endl;
+            break;
+        case OutputFormat::Json:
+            std::cout << "{\"threads\": " << pool.size() << ", \"total_ns\": " << total.count()
+                      << ", \"day_elapsed_ns\": {";
+            for (size_t i = 0; i < day_times.size(); ++i) {
+                std::cout << (i > 0 ? ", " : "") << "\"" << day_times[i].first << "\": " << day_times[i].second.count();
+            }
+            std::cout << "}}" << std::endl;
+            break;
+        case OutputFormat::Csv:
+            break;
+    }
+    
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,23 @@
+// SPDX-FileCopyrightText: 2025 SternXD
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "common.h"
+#include <map>
+
+// Run every phase of a day `iterations` times and print min/median/p99 timings as JSON
+void run_bench(const DayInfo& day, size_t iterations);
+
+// Run every day concurrently on `threads` workers (0 = one per core) and print the
+// results in day order with per-day and total wall time. Returns the process exit code.
+int run_all(const std::map<int, DayInfo>& days, size_t threads, OutputFormat format = OutputFormat::Text);
+
+// Solve a day in one pass over a stream (a file or stdin), for days that support it
+// (see DaySolution::solve_stream); throws RisError otherwise
+void run_stream(const DayInfo& day, std::istream& input, Answer& answer, std::ostream& log = std::cout);
+
+// Solve a day normally and again with its reference path, printing both answers per
+// part. Returns the process exit code: nonzero on a mismatch or if the day has no
+// reference path.
+int run_verify(const DayInfo& day, std::ostream& out = std::cout);
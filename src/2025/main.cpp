@@ -1,45 +1,153 @@
 // SPDX-FileCopyrightText: 2025 SternXD
 // SPDX-License-Identifier: MIT
 
+#include <fstream>
 #include <iostream>
 #include <string>
-#include <map>
-#include <functional>
+#include <vector>
 
 #include "common.h"
+#include "driver.h"
+#include "profile.h"
 
-// Day headers
-#include "day_1/day_1.h"
-#include "day_2/day_2.h"
-#include "day_3/day_3.h"
-#include "day_4/day_4.h"
-#include "day_5/day_5.h"
+// Most threads --all will start; far more than there are days to run
+const size_t MAX_THREADS = 256;
 
 void print_usage(const char* program_name) {
-    std::cerr << "Usage: " << program_name << " <day_number>" << std::endl;
+    std::cerr << "Usage: " << program_name << " [--format text|json|csv] [--profile] <day_number>" << std::endl;
     std::cerr << "  or:  " << program_name << " -<day_number>" << std::endl;
     std::cerr << "  or:  " << program_name << " --day <day_number>" << std::endl;
+    std::cerr << "  or:  " << program_name << " --bench <iterations> <day_number>" << std::endl;
+    std::cerr << "  or:  " << program_name << " --stream <day_number> [file|-]" << std::endl;
+    std::cerr << "  or:  " << program_name << " --verify <day_number>" << std::endl;
+    std::cerr << "  or:  " << program_name << " --all [threads]" << std::endl;
+    std::cerr << "  or:  " << program_name << " --list" << std::endl;
     std::cerr << std::endl;
     std::cerr << "Examples:" << std::endl;
     std::cerr << "  " << program_name << " 1" << std::endl;
     std::cerr << "  " << program_name << " -2" << std::endl;
     std::cerr << "  " << program_name << " --day 1" << std::endl;
+    std::cerr << "  " << program_name << " --bench 100 4" << std::endl;
+    std::cerr << "  " << program_name << " --stream 1 < input.txt" << std::endl;
+    std::cerr << "  " << program_name << " --verify 2" << std::endl;
+    std::cerr << "  " << program_name << " --all" << std::endl;
+    std::cerr << "  " << program_name << " --format json --all" << std::endl;
+    std::cerr << "  " << program_name << " --profile 4" << std::endl;
+}
+
+// The profile table goes to stderr whenever stdout carries structured output
+void print_profile_if_enabled(OutputFormat format) {
+    if (profiling_enabled()) {
+        print_profile(format == OutputFormat::Text ? std::cout : std::cerr);
+    }
 }
 
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    
+    // Options that apply to every mode can appear anywhere on the command line
+    OutputFormat format = OutputFormat::Text;
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] != "--format") {
+            continue;
+        }
+        RisResult<OutputFormat> parsed = i + 1 < args.size() ? parse_output_format(args[i + 1]) : std::nullopt;
+        if (!parsed) {
+            std::cerr << "Error: --format needs one of text, json or csv" << std::endl;
+            return 1;
+        }
+        format = *parsed;
+        args.erase(args.begin() + i, args.begin() + i + 2);
+        break;
+    }
+    
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (args[i] == "--profile") {
+            enable_profiling();
+            args.erase(args.begin() + i);
+            break;
+        }
+    }
+    
+    if (args.empty()) {
         print_usage(argv[0]);
         return 1;
     }
     
+    const DayRegistry& registry = DayRegistry::instance();
+    
     int day_num = -1;
-    std::string arg = argv[1];
+    std::optional<size_t> bench_iterations;
+    std::optional<std::string> stream_path;
+    bool verify = false;
+    const std::string& arg = args[0];
     
-    if (arg == "--day" && argc >= 3) {
+    if (arg == "--list") {
+        for (const auto& [number, day] : registry.days()) {
+            std::cout << "Day " << number << ": " << day.title << std::endl;
+        }
+        return 0;
+    } else if (arg == "--all") {
+        size_t threads = 0;
+        if (args.size() >= 2) {
+            // Digits only, so "-1" and "4x" don't get through as huge or partial counts
+            RisResult<uint64_t> count = parse_u64(args[1]);
+            if (!count || *count > MAX_THREADS) {
+                std::cerr << "Error: Invalid thread count: " << args[1] << " (0 to " << MAX_THREADS << ")" << std::endl;
+                return 1;
+            }
+            threads = static_cast<size_t>(*count);
+        }
+        try {
+            int result = run_all(registry.days(), threads, format);
+            print_profile_if_enabled(format);
+            return result;
+        } catch (const RisError& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        } catch (const std::exception& e) {
+            std::cerr << "Unexpected error: " << e.what() << std::endl;
+            return 1;
+        }
+    } else if (arg == "--bench") {
+        if (args.size() < 3) {
+            print_usage(argv[0]);
+            return 1;
+        }
         try {
-            day_num = std::stoi(argv[2]);
+            bench_iterations = std::stoull(args[1]);
         } catch (const std::exception&) {
-            std::cerr << "Error: Invalid day number: " << argv[2] << std::endl;
+            std::cerr << "Error: Invalid iteration count: " << args[1] << std::endl;
+            return 1;
+        }
+        try {
+            day_num = std::stoi(args[2]);
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid day number: " << args[2] << std::endl;
+            return 1;
+        }
+    } else if (arg == "--stream" && args.size() >= 2) {
+        try {
+            day_num = std::stoi(args[1]);
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid day number: " << args[1] << std::endl;
+            return 1;
+        }
+        // stdin unless a file is given
+        stream_path = args.size() >= 3 ? args[2] : "-";
+    } else if (arg == "--verify" && args.size() >= 2) {
+        try {
+            day_num = std::stoi(args[1]);
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid day number: " << args[1] << std::endl;
+            return 1;
+        }
+        verify = true;
+    } else if (arg == "--day" && args.size() >= 2) {
+        try {
+            day_num = std::stoi(args[1]);
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid day number: " << args[1] << std::endl;
             return 1;
         }
     } else if (arg[0] == '-') {
@@ -59,29 +167,53 @@ int main(int argc, char* argv[]) {
         }
     }
     
-    std::map<int, std::function<void(Answer&)>> day_functions = {
-        {1, run_day_1},
-        {2, run_day_2},
-        {3, run_day_3},
-        {4, run_day_4},
-        {5, run_day_5},
-    };
-    
     if (day_num < 1 || day_num > 25) {
         std::cerr << "Error: Day number must be between 1 and 25." << std::endl;
         return 1;
     }
     
-    auto it = day_functions.find(day_num);
-    if (it == day_functions.end()) {
+    const DayInfo* day = registry.find(day_num);
+    if (day == nullptr) {
         std::cerr << "Error: Day " << day_num << " is not implemented yet." << std::endl;
         return 1;
     }
     
     try {
-        Answer answer;
-        it->second(answer);
-        answer.print();
+        if (bench_iterations) {
+            run_bench(*day, *bench_iterations);
+            print_profile_if_enabled(OutputFormat::Json);
+            return 0;
+        }
+        
+        if (verify) {
+            int result = run_verify(*day);
+            print_profile_if_enabled(OutputFormat::Text);
+            return result;
+        }
+        
+        // Keep stdout machine-readable when emitting JSON or CSV
+        std::ostream& log = format == OutputFormat::Text ? std::cout : std::cerr;
+        Answer answer(day_num);
+        
+        if (stream_path) {
+            if (*stream_path == "-") {
+                run_stream(*day, std::cin, answer, log);
+            } else {
+                std::ifstream file(*stream_path, std::ios::binary);
+                if (!file) {
+                    throw RisError("Failed to open input file: " + *stream_path);
+                }
+                run_stream(*day, file, answer, log);
+            }
+            answer.print(format);
+            print_profile_if_enabled(format);
+            return 0;
+        }
+        
+        std::unique_ptr<DaySolution> solution = day->create();
+        run_solution(*solution, answer, log);
+        answer.print(format);
+        print_profile_if_enabled(format);
         return 0;
     } catch (const RisError& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -91,4 +223,3 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 }
-
@@ -0,0 +1,235 @@
+// SPDX-FileCopyrightText: 2025 SternXD
+// SPDX-License-Identifier: MIT
+
+#include "profile.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#define AOC_HAVE_PERF 1
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::atomic<bool> enabled{false};
+
+struct ScopeStats {
+    std::string name;
+    uint64_t calls = 0;
+    std::chrono::nanoseconds wall{0};
+    uint64_t counters[CounterSample::COUNT] = {};
+    bool valid[CounterSample::COUNT] = {true, true, true, true};
+    bool parallel = false;
+};
+
+std::mutex stats_mutex;
+std::vector<ScopeStats> stats;
+
+#ifdef AOC_HAVE_PERF
+
+// One counter group per thread, opened on first use and left running
+class PerfCounters {
+public:
+    PerfCounters() {
+        static const uint64_t configs[CounterSample::COUNT] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES,
+        };
+        
+        for (size_t i = 0; i < CounterSample::COUNT; ++i) {
+            int fd = open_counter(configs[i], leader_);
+            if (fd < 0) {
+                if (leader_ < 0) {
+                    return; // no cycles counter means perf is off limits altogether
+                }
+                continue;
+            }
+            if (leader_ < 0) {
+                leader_ = fd;
+            }
+            fds_.push_back(fd);
+            slots_.push_back(i);
+        }
+        
+        ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    
+    ~PerfCounters() {
+        for (int fd : fds_) {
+            close(fd);
+        }
+    }
+    
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    
+    CounterSample read_sample() const {
+        CounterSample sample;
+        if (leader_ < 0) {
+            return sample;
+        }
+        
+        // PERF_FORMAT_GROUP: number of counters, then one value per counter
+        uint64_t buffer[1 + CounterSample::COUNT];
+        ssize_t bytes = read(leader_, buffer, sizeof(buffer));
+        if (bytes < static_cast<ssize_t>(sizeof(uint64_t)) || buffer[0] != slots_.size()) {
+            return sample;
+        }
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            sample.values[slots_[i]] = buffer[1 + i];
+            sample.valid[slots_[i]] = true;
+        }
+        return sample;
+    }
+
+private:
+    static int open_counter(uint64_t config, int group_fd) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = group_fd < 0 ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+    }
+    
+    int leader_ = -1;
+    std::vector<int> fds_;
+    std::vector<size_t> slots_;
+};
+
+CounterSample read_counters() {
+    thread_local PerfCounters counters;
+    return counters.read_sample();
+}
+
+#else
+
+CounterSample read_counters() {
+    return CounterSample{};
+}
+
+#endif
+
+void record(const char* name, std::chrono::nanoseconds wall, const CounterSample& start, const CounterSample& end,
+            bool parallel) {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    
+    ScopeStats* entry = nullptr;
+    for (auto& existing : stats) {
+        if (existing.name == name) {
+            entry = &existing;
+            break;
+        }
+    }
+    if (entry == nullptr) {
+        entry = &stats.emplace_back();
+        entry->name = name;
+    }
+    
+    entry->calls++;
+    entry->wall += wall;
+    entry->parallel = entry->parallel || parallel;
+    for (size_t i = 0; i < CounterSample::COUNT; ++i) {
+        if (start.valid[i] && end.valid[i]) {
+            entry->counters[i] += end.values[i] - start.values[i];
+        } else {
+            entry->valid[i] = false;
+        }
+    }
+}
+
+void print_counter(std::ostream& out, const ScopeStats& entry, size_t index, int width) {
+    if (entry.valid[index]) {
+        out << std::setw(width) << entry.counters[index];
+    } else {
+        out << std::setw(width) << "n/a";
+    }
+}
+
+} // anonymous namespace
+
+ProfileScope::ProfileScope(const char* name)
+    : name_(name), active_(enabled.load(std::memory_order_relaxed)) {
+    if (active_) {
+        counters_ = read_counters();
+        dispatches_ = helper_dispatch_count();
+        start_ = std::chrono::steady_clock::now();
+    }
+}
+
+ProfileScope::~ProfileScope() {
+    if (!active_) {
+        return;
+    }
+    auto wall = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+    CounterSample end = read_counters();
+    record(name_, wall, counters_, end, helper_dispatch_count() != dispatches_);
+}
+
+void enable_profiling() {
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+bool profiling_enabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void print_profile(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    
+    out << std::left << std::setw(24) << "scope" << std::right
+        << std::setw(8) << "calls"
+        << std::setw(14) << "wall ms"
+        << std::setw(16) << "cycles"
+        << std::setw(16) << "instructions"
+        << std::setw(7) << "IPC"
+        << std::setw(14) << "cache-miss"
+        << std::setw(14) << "branch-miss" << std::endl;
+    
+    bool any_parallel = false;
+    for (const auto& entry : stats) {
+        any_parallel = any_parallel || entry.parallel;
+        out << std::left << std::setw(24) << (entry.parallel ? entry.name + " *" : entry.name) << std::right
+            << std::setw(8) << entry.calls
+            << std::setw(14) << std::fixed << std::setprecision(3)
+            << std::chrono::duration<double, std::milli>(entry.wall).count();
+        print_counter(out, entry, 0, 16);
+        print_counter(out, entry, 1, 16);
+        if (entry.valid[0] && entry.valid[1] && entry.counters[0] > 0) {
+            out << std::setw(7) << std::setprecision(2)
+                << static_cast<double>(entry.counters[1]) / static_cast<double>(entry.counters[0]);
+        } else {
+            out << std::setw(7) << "n/a";
+        }
+        print_counter(out, entry, 2, 14);
+        print_counter(out, entry, 3, 14);
+        out << std::endl;
+    }
+    
+    bool any_counters = false;
+    for (const auto& entry : stats) {
+        any_counters = any_counters || entry.valid[0];
+    }
+    if (!stats.empty() && !any_counters) {
+        out << "(hardware counters unavailable; check /proc/sys/kernel/perf_event_paranoid)" << std::endl;
+    }
+    if (any_parallel) {
+        out << "* ran part of its work on pool helpers; counters cover the calling thread only" << std::endl;
+    }
+}
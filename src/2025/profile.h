@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2025 SternXD
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+// Hardware counters sampled around a scope. On Linux these come from perf_event_open;
+// anywhere else, or when the kernel doesn't allow it, only wall time is recorded.
+// Counters follow the thread that opened the scope only: work a parallel_for hands to
+// pool helpers shows up in wall time but not in cycles, instructions or misses.
+struct CounterSample {
+    static constexpr size_t COUNT = 4; // cycles, instructions, cache misses, branch misses
+    
+    uint64_t values[COUNT] = {};
+    bool valid[COUNT] = {};
+};
+
+// Times the enclosing scope and adds the result to the profile under `name`.
+// Does nothing beyond one branch unless profiling was enabled.
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name);
+    ~ProfileScope();
+    
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name_;
+    bool active_;
+    std::chrono::steady_clock::time_point start_;
+    size_t dispatches_ = 0;
+    CounterSample counters_;
+};
+
+#define AOC_SCOPE_CONCAT_INNER(a, b) a##b
+#define AOC_SCOPE_CONCAT(a, b) AOC_SCOPE_CONCAT_INNER(a, b)
+#define AOC_SCOPE(name) ProfileScope AOC_SCOPE_CONCAT(aoc_scope_, __LINE__)(name)
+
+void enable_profiling();
+bool profiling_enabled();
+
+// Summary table of every recorded scope, in the order they were first seen. Scopes
+// that handed work to pool helpers are marked, since their counters are partial.
+void print_profile(std::ostream& out = std::cout);
@@ -0,0 +1,16 @@
+// SPDX-FileCopyrightText: 2025 SternXD
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+// x86 SIMD availability. AVX2 kernels are compiled per function with AOC_TARGET_AVX2,
+// so the build needs no -mavx2; check cpu_has_avx2() before calling one.
+#if defined(__x86_64__) || defined(_M_X64)
+#define AOC_HAVE_SSE2 1
+#include <immintrin.h>
+#endif
+
+#if defined(AOC_HAVE_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define AOC_HAVE_AVX2 1
+#define AOC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2025 SternXD
+// SPDX-License-Identifier: MIT
+
+#include "thread_pool.h"
+
+namespace {
+
+thread_local size_t helper_dispatches = 0;
+
+} // anonymous namespace
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = default_thread_count();
+    }
+    
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this] { worker_loop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::default_thread_count() {
+    size_t threads = std::thread::hardware_concurrency();
+    return threads > 0 ? threads : 1;
+}
+
+void ThreadPool::worker_loop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            
+            // Drain remaining work before shutting down
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        task();
+    }
+}
+
+ThreadPool& compute_pool() {
+    static ThreadPool pool(ThreadPool::default_thread_count());
+    return pool;
+}
+
+size_t parallel_worker_count(size_t count, size_t max_threads) {
+    size_t threads = max_threads == 0 ? compute_pool().size() : max_threads;
+    return std::max<size_t>(std::min(threads, count), 1);
+}
+
+size_t helper_dispatch_count() {
+    return helper_dispatches;
+}
+
+void note_helper_dispatch() {
+    ++helper_dispatches;
+}
@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: 2025 SternXD
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed-size pool of worker threads pulling tasks from a shared queue
+class ThreadPool {
+public:
+    // Zero threads means one per hardware thread
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    template<typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<F>> {
+        using Result = std::invoke_result_t<F>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> future = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push([packaged] { (*packaged)(); });
+        }
+        cv_.notify_one();
+        return future;
+    }
+    
+    size_t size() const {
+        return workers_.size();
+    }
+    
+    static size_t default_thread_count();
+
+private:
+    void worker_loop();
+    
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+};
+
+// Pool shared by the data-parallel kernels, one thread per core
+ThreadPool& compute_pool();
+
+// Number of threads parallel_for(_workers) uses for `count` items and `max_threads`
+size_t parallel_worker_count(size_t count, size_t max_threads = 0);
+
+// How many times this thread has handed parallel_for items to pool helpers. Lets the
+// profiler tell which scopes did part of their work on other threads.
+size_t helper_dispatch_count();
+void note_helper_dispatch();
+
+// Calls body(i, worker) for every i in [0, count) using up to `max_threads` threads
+// (0 = one per core), the caller included. `worker` is a dense index in
+// [0, parallel_worker_count(count, max_threads)) that no two threads share, for keeping
+// per-thread state without locks. Items are handed out one at a time as threads free
+// up. The calling thread takes items too, and the wait is on the items rather than the
+// helper tasks, so this is safe to call from inside a pool task. The first exception
+// thrown by `body` is rethrown here.
+template<typename F>
+void parallel_for_workers(size_t count, F&& body, size_t max_threads = 0) {
+    if (count == 0) {
+        return;
+    }
+    
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::atomic<size_t> workers{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+    auto state = std::make_shared<State>();
+    
+    // Helpers may start after all items are gone; they then return straight away
+    auto work = [state, count, &body] {
+        size_t worker = state->workers.fetch_add(1);
+        size_t i;
+        while ((i = state->next.fetch_add(1)) < count) {
+            try {
+                body(i, worker);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (!state->error) {
+                    state->error = std::current_exception();
+                }
+            }
+            if (state->done.fetch_add(1) + 1 == count) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+    
+    ThreadPool& pool = compute_pool();
+    size_t helpers = parallel_worker_count(count, max_threads) - 1;
+    for (size_t i = 0; i < helpers; ++i) {
+        pool.submit(work);
+    }
+    if (helpers > 0) {
+        note_helper_dispatch();
+    }
+    work();
+    
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&] { return state->done.load() == count; });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+// parallel_for_workers without the worker index
+template<typename F>
+void parallel_for(size_t count, F&& body, size_t max_threads = 0) {
+    parallel_for_workers(count, [&body](size_t i, size_t) { body(i); }, max_threads);
+}
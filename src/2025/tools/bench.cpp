@@ -0,0 +1,470 @@
+// SPDX-FileCopyrightText: 2025 SternXD
+// SPDX-License-Identifier: MIT
+
+// Microbenchmarks for the per-day kernels. Each benchmark runs over a few input sizes,
+// repeats until it has run for at least --min-time, and reports time per iteration
+// and items per second, so a regression in a single kernel shows up on its own.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "rng.h"
+#include "day_1/day_1.h"
+#include "day_2/day_2.h"
+#include "day_3/day_3.h"
+#include "day_4/day_4.h"
+#include "day_5/day_5.h"
+#include "thread_pool.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps results observable so the optimizer can't drop the work being measured
+volatile uint64_t benchmark_sink = 0;
+
+class Harness {
+public:
+    Harness(std::vector<std::string> filters, std::chrono::milliseconds min_time)
+        : filters_(std::move(filters)), min_time_(min_time) {}
+    
+    bool selected(const std::string& name) const {
+        if (filters_.empty()) {
+            return true;
+        }
+        return std::any_of(filters_.begin(), filters_.end(), [&](const std::string& filter) {
+            return name.find(filter) != std::string::npos;
+        });
+    }
+    
+    void print_header() const {
+        std::cout << std::left << std::setw(28) << "benchmark" << std::right
+                  << std::setw(10) << "size"
+                  << std::setw(12) << "iterations"
+                  << std::setw(16) << "ns/iter"
+                  << std::setw(16) << "Mitems/s" << std::endl;
+    }
+    
+    // `body` does one iteration over `items` items and returns something to sink
+    template<typename F>
+    void run(const std::string& name, size_t size, size_t items, F&& body) const {
+        size_t iterations = 1;
+        std::chrono::nanoseconds elapsed{0};
+        
+        while (true) {
+            auto start = Clock::now();
+            uint64_t sink = 0;
+            for (size_t i = 0; i < iterations; ++i) {
+                sink += body();
+            }
+            elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+            benchmark_sink = benchmark_sink + sink;
+            
+            if (elapsed >= min_time_) {
+                break;
+            }
+            
+            // Aim a bit past min_time from what the last round took, growing at most 10x
+            double per_iteration = std::max<double>(1.0, static_cast<double>(elapsed.count()) / iterations);
+            double wanted = 1.2 * std::chrono::duration<double, std::nano>(min_time_).count() / per_iteration;
+            iterations = static_cast<size_t>(std::clamp<double>(wanted, iterations + 1.0, iterations * 10.0));
+        }
+        
+        double ns_per_iteration = static_cast<double>(elapsed.count()) / iterations;
+        double items_per_second = items * 1e9 / ns_per_iteration;
+        
+        std::cout << std::left << std::setw(28) << name << std::right
+                  << std::setw(10) << size
+                  << std::setw(12) << iterations
+                  << std::setw(16) << std::fixed << std::setprecision(1) << ns_per_iteration
+                  << std::setw(16) << std::setprecision(2) << items_per_second / 1e6 << std::endl;
+    }
+
+private:
+    std::vector<std::string> filters_;
+    std::chrono::milliseconds min_time_;
+};
+
+void bench_day_1(const Harness& harness) {
+    for (size_t size : {size_t{1} << 10, size_t{1} << 16, size_t{1} << 20}) {
+        Rng rng(size);
+        std::vector<Rotation> rotations;
+        for (size_t i = 0; i < size; ++i) {
+            rotations.push_back(Rotation{rng.next() & 1 ? Direction::Right : Direction::Left, rng.between(1, 999)});
+        }
+        RotationList packed;
+        for (const auto& rotation : rotations) {
+            packed.push_back(rotation);
+        }
+        
+        if (harness.selected("day1.dial_add")) {
+            harness.run("day1.dial_add", size, size, [&] {
+                Dial<100> dial;
+                uint64_t zeros = 0;
+                for (const auto& rotation : rotations) {
+                    dial.add(rotation);
+                    zeros += dial.position == 0;
+                }
+                return zeros;
+            });
+        }
+        if (harness.selected("day1.count_zeros_1t")) {
+            harness.run("day1.count_zeros_1t", size, size, [&] { return count_zeros(packed, 50, 1).clicks; });
+        }
+        if (harness.selected("day1.count_zeros_mt")) {
+            harness.run("day1.count_zeros_mt", size, size, [&] { return count_zeros(packed).clicks; });
+        }
+        if (harness.selected("day1.add_counting_zeros")) {
+            harness.run("day1.add_counting_zeros", size, size, [&] {
+                Dial<100> dial;
+                uint64_t zeros = 0;
+                for (const auto& rotation : rotations) {
+                    zeros += dial.add_counting_zeros(rotation);
+                }
+                return zeros;
+            });
+        }
+        if (harness.selected("day1.apply_batch")) {
+            harness.run("day1.apply_batch", size, size, [&] {
+                Dial<100> dial;
+                return dial.apply_batch(packed.deltas().data(), packed.size()).clicks;
+            });
+        }
+        // Same kernel with the modulus only known at runtime
+        if (harness.selected("day1.apply_batch_runtime")) {
+            harness.run("day1.apply_batch_runtime", size, size, [&] {
+                Dial<0> dial(100);
+                return dial.apply_batch(packed.deltas().data(), packed.size()).clicks;
+            });
+        }
+    }
+}
+
+// Consecutive ids from a 10-digit start, like a wide range in the puzzle
+template<typename Validator>
+void bench_validator(const Harness& harness, const std::string& name) {
+    if (!harness.selected(name)) {
+        return;
+    }
+    for (size_t size : {size_t{1} << 10, size_t{1} << 16, size_t{1} << 20}) {
+        const uint64_t first = 1234500000;
+        harness.run(name, size, size, [&] {
+            uint64_t invalid_sum = 0;
+            for (uint64_t n = first; n < first + size; ++n) {
+                if (!Validator::is_valid(n)) {
+                    invalid_sum += n;
+                }
+            }
+            return invalid_sum;
+        });
+    }
+}
+
+// Both validators per id over one wide range: the batch checker alone, then through
+// the chunked multi-threaded sweep
+void bench_day_2_sweep(const Harness& harness) {
+    for (size_t size : {size_t{1} << 16, size_t{1} << 20}) {
+        const uint64_t first = 1234500000;
+        if (harness.selected("day2.sum_invalid_ids")) {
+            harness.run("day2.sum_invalid_ids", size, size, [&] { return sum_invalid_ids(first, first + size).part_2; });
+        }
+        if (harness.selected("day2.sweep")) {
+            std::vector<Range> ranges{Range(first, first + size)};
+            harness.run("day2.sweep", size, size, [&] { return sweep_ranges(ranges).part_2; });
+        }
+    }
+}
+
+std::vector<uint8_t> random_bank(Rng& rng, size_t length) {
+    std::vector<uint8_t> bank;
+    for (size_t i = 0; i < length; ++i) {
+        bank.push_back(static_cast<uint8_t>(rng.between(1, 9)));
+    }
+    return bank;
+}
+
+void bench_day_3(const Harness& harness) {
+    for (size_t size : {size_t{100}, size_t{1000}, size_t{10000}}) {
+        Rng rng(size);
+        std::vector<uint8_t> bank = random_bank(rng, size);
+        
+        if (harness.selected("day3.max_joltage_2")) {
+            harness.run("day3.max_joltage_2", size, size, [&] { return max_joltage_2(bank); });
+        }
+        if (harness.selected("day3.max_joltage_2_scan")) {
+            harness.run("day3.max_joltage_2_scan", size, size, [&] { return max_joltage_2_scan(bank); });
+            
+            // Without 9s the scans can't stop early, so this is the full-length cost
+            std::vector<uint8_t> no_nines = bank;
+            std::replace(no_nines.begin(), no_nines.end(), uint8_t{9}, uint8_t{8});
+            harness.run("day3.max_joltage_2_scan_full", size, size, [&] { return max_joltage_2_scan(no_nines); });
+        }
+        if (harness.selected("day3.max_joltage_12")) {
+            harness.run("day3.max_joltage_12", size, size, [&] { return max_joltage_12(bank); });
+        }
+        if (harness.selected("day3.max_joltage_k12")) {
+            harness.run("day3.max_joltage_k12", size, size, [&] { return max_joltage(bank, 12); });
+        }
+        if (harness.selected("day3.max_joltage_k100")) {
+            harness.run("day3.max_joltage_k100", size, size, [&] { return max_joltage_string(bank, 100).size(); });
+        }
+    }
+}
+
+void bench_day_4(const Harness& harness) {
+    for (size_t side : {size_t{64}, size_t{256}, size_t{1024}}) {
+        Rng rng(side);
+        std::vector<std::string> lines(side, std::string(side, '.'));
+        for (auto& line : lines) {
+            for (char& cell : line) {
+                cell = rng.next() % 8 < 5 ? '@' : '.';
+            }
+        }
+        PaperGrid grid(lines);
+        
+        if (harness.selected("day4.count_adjacent_rolls")) {
+            harness.run("day4.count_adjacent_rolls", side, side * side, [&] {
+                uint64_t total = 0;
+                for (size_t row = 0; row < side; ++row) {
+                    for (size_t col = 0; col < side; ++col) {
+                        total += grid.count_adjacent_rolls(row, col);
+                    }
+                }
+                return total;
+            });
+        }
+        if (harness.selected("day4.bitboard_accessible")) {
+            RollBitboard board(grid);
+            std::vector<uint64_t> mask;
+            harness.run("day4.bitboard_accessible", side, side * side, [&] {
+                board.accessible(mask);
+                return mask.back();
+            });
+        }
+        if (harness.selected("day4.count_accessible_1t")) {
+            RollBitboard board(grid);
+            harness.run("day4.count_accessible_1t", side, side * side, [&] { return count_accessible(board, 1); });
+        }
+        if (harness.selected("day4.count_accessible_mt")) {
+            RollBitboard board(grid);
+            harness.run("day4.count_accessible_mt", side, side * side, [&] { return count_accessible(board); });
+        }
+        if (harness.selected("day4.remove_in_rounds_1t")) {
+            RollBitboard board(grid);
+            harness.run("day4.remove_in_rounds_1t", side, side * side, [&] { return remove_in_rounds(board, 1); });
+        }
+        if (harness.selected("day4.remove_in_rounds_mt")) {
+            RollBitboard board(grid);
+            harness.run("day4.remove_in_rounds_mt", side, side * side, [&] { return remove_in_rounds(board); });
+        }
+        if (harness.selected("day4.peel_rolls")) {
+            RollBitboard board(grid);
+            harness.run("day4.peel_rolls", side, side * side, [&] { return peel_rolls(board).removed; });
+        }
+    }
+}
+
+double milliseconds_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Thread scaling of the tiled day 4 stencil on a side x side grid: part 1, then up to
+// `max_rounds` rounds of part 2 (0 = until nothing is left to remove), for 1, 2, 4, ...
+// threads up to one per core. The board is built straight from random words, since a
+// 50k x 50k grid as text would be 2.5 GB.
+void report_day_4_scaling(size_t side, size_t band_rows, size_t max_rounds) {
+    Rng rng(side);
+    size_t words_per_row = (side + 63) / 64;
+    std::vector<uint64_t> words(side * words_per_row);
+    for (uint64_t& word : words) {
+        // 1 - (1/2 * 3/4) = 5/8 of the cells are rolls, like the real input
+        uint64_t a = rng.next();
+        uint64_t b = rng.next();
+        word = a | (b & rng.next());
+    }
+    RollBitboard board(side, side, std::move(words));
+    
+    size_t max_threads = compute_pool().size();
+    std::vector<size_t> thread_counts;
+    for (size_t threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(max_threads);
+    
+    double part_1_base = 0;
+    double part_2_base = 0;
+    std::cout << std::fixed << std::setprecision(1);
+    for (size_t threads : thread_counts) {
+        TiledStencil stencil(board, threads, band_rows);
+        if (threads == thread_counts.front()) {
+            std::cout << "day 4 tiled stencil, " << side << "x" << side << " grid, " << stencil.band_rows()
+                      << " rows per band (" << stencil.bands() << " bands)" << std::endl;
+            std::cout << std::setw(8) << "threads" << std::setw(12) << "part1 ms" << std::setw(10) << "speedup"
+                      << std::setw(8) << "rounds" << std::setw(12) << "part2 ms" << std::setw(10) << "speedup"
+                      << std::setw(12) << "removed" << std::endl;
+        }
+        
+        auto start = Clock::now();
+        benchmark_sink = benchmark_sink + stencil.count_accessible();
+        double part_1_ms = milliseconds_since(start);
+        
+        start = Clock::now();
+        size_t rounds = 0;
+        size_t removed = 0;
+        while (max_rounds == 0 || rounds < max_rounds) {
+            size_t round_removed = stencil.remove_round();
+            ++rounds;
+            removed += round_removed;
+            if (round_removed == 0) {
+                break;
+            }
+        }
+        double part_2_ms = milliseconds_since(start);
+        
+        if (threads == thread_counts.front()) {
+            part_1_base = part_1_ms;
+            part_2_base = part_2_ms;
+        }
+        std::cout << std::setw(8) << threads
+                  << std::setw(12) << part_1_ms << std::setw(10) << part_1_base / part_1_ms
+                  << std::setw(8) << rounds
+                  << std::setw(12) << part_2_ms << std::setw(10) << part_2_base / part_2_ms
+                  << std::setw(12) << removed << std::endl;
+    }
+    
+    // Peeling, for the crossover: part 2 runs tiled rounds until they'd cost more than this
+    if (side * side > PEEL_MAX_CELLS) {
+        std::cout << "peel_rolls: skipped, " << side << "x" << side << " is over its " << PEEL_MAX_CELLS
+                  << " cell limit" << std::endl;
+    } else if (max_rounds != 0) {
+        std::cout << "peel_rolls: skipped, it can't stop after " << max_rounds << " rounds" << std::endl;
+    } else {
+        auto start = Clock::now();
+        PeelResult peel = peel_rolls(board);
+        double peel_ms = milliseconds_since(start);
+        std::cout << "peel_rolls (1 thread): " << peel_ms << " ms, " << peel.rounds << " rounds, "
+                  << peel.removed << " removed" << std::endl;
+    }
+}
+
+std::vector<FreshRange> random_ranges(Rng& rng, size_t count) {
+    const uint64_t id_space = 1000000000000000ULL;
+    std::vector<FreshRange> ranges;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t start = rng.between(1, id_space);
+        ranges.push_back(FreshRange{start, start + rng.between(0, id_space / count)});
+    }
+    return ranges;
+}
+
+void bench_day_5(const Harness& harness) {
+    for (size_t size : {size_t{1} << 10, size_t{1} << 16, size_t{1} << 20}) {
+        Rng rng(size);
+        std::vector<FreshRange> ranges = random_ranges(rng, size);
+        
+        // merge_ranges takes its input by value, so the copy is part of every iteration
+        if (harness.selected("day5.merge_ranges")) {
+            harness.run("day5.merge_ranges", size, size, [&] { return merge_ranges(ranges).size(); });
+        }
+        
+        if (harness.selected("day5.contains")) {
+            std::vector<FreshRange> merged = merge_ranges(ranges);
+            std::vector<uint64_t> ids;
+            for (size_t i = 0; i < 4096; ++i) {
+                ids.push_back(rng.between(1, 1000000000000000ULL));
+            }
+            harness.run("day5.contains", size, ids.size(), [&] {
+                uint64_t fresh = 0;
+                for (uint64_t id : ids) {
+                    fresh += contains(merged, id);
+                }
+                return fresh;
+            });
+        }
+    }
+}
+
+void print_usage(const char* program_name) {
+    std::cerr << "Usage: " << program_name << " [--min-time <ms>] [filter...]" << std::endl;
+    std::cerr << "       " << program_name << " --scaling [side] [--band-rows <n>] [--rounds <n>]" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "Runs every benchmark whose name contains one of the filters (all by default)." << std::endl;
+    std::cerr << "--scaling reports how the day 4 tiled stencil scales from 1 thread to one per core" << std::endl;
+    std::cerr << "on a side x side grid (50000 by default); --rounds caps the part 2 rounds timed." << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "Examples:" << std::endl;
+    std::cerr << "  " << program_name << std::endl;
+    std::cerr << "  " << program_name << " day4" << std::endl;
+    std::cerr << "  " << program_name << " --min-time 50 day2.validator" << std::endl;
+    std::cerr << "  " << program_name << " --scaling 20000 --rounds 10" << std::endl;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> filters;
+    std::chrono::milliseconds min_time{200};
+    bool scaling = false;
+    size_t side = 50000;
+    size_t band_rows = 0;
+    size_t max_rounds = 0;
+    
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--min-time" && i + 1 < argc) {
+                min_time = std::chrono::milliseconds(std::stoull(argv[++i]));
+            } else if (arg == "--scaling") {
+                scaling = true;
+            } else if (arg == "--band-rows" && i + 1 < argc) {
+                band_rows = std::stoull(argv[++i]);
+            } else if (arg == "--rounds" && i + 1 < argc) {
+                max_rounds = std::stoull(argv[++i]);
+            } else if (scaling && arg[0] != '-') {
+                side = std::stoull(arg);
+            } else if (arg == "--help" || arg[0] == '-') {
+                print_usage(argv[0]);
+                return arg == "--help" ? 0 : 1;
+            } else {
+                filters.push_back(arg);
+            }
+        }
+    } catch (const std::exception&) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    if (scaling) {
+        try {
+            report_day_4_scaling(side, band_rows, max_rounds);
+        } catch (const RisError& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    
+    Harness harness(filters, min_time);
+    harness.print_header();
+    
+    try {
+        bench_day_1(harness);
+        bench_validator<NumberValidator1>(harness, "day2.validator1");
+        bench_validator<NumberValidator2>(harness, "day2.validator2");
+        bench_day_2_sweep(harness);
+        bench_day_3(harness);
+        bench_day_4(harness);
+        bench_day_5(harness);
+    } catch (const RisError& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,244 @@
+// SPDX-FileCopyrightText: 2025 SternXD
+// SPDX-License-Identifier: MIT
+
+#ifdef _MSC_VER
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+// Synthetic puzzle input generator for stress benchmarks. Output is seeded and
+// reproducible, and written as <out>/day_N so it can be picked up with AOC_INPUT_DIR.
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "common.h"
+#include "rng.h"
+
+namespace {
+
+// Buffered file writer, so generating 10^8 lines isn't bound by stdio calls
+class OutputFile {
+public:
+    explicit OutputFile(const std::string& path) : path_(path), file_(std::fopen(path.c_str(), "wb")) {
+        if (file_ == nullptr) {
+            throw RisError("Could not open output file: " + path);
+        }
+        buffer_.reserve(BUFFER_SIZE + 64);
+    }
+    
+    ~OutputFile() {
+        if (file_ != nullptr) {
+            std::fclose(file_);
+        }
+    }
+    
+    OutputFile(const OutputFile&) = delete;
+    OutputFile& operator=(const OutputFile&) = delete;
+    
+    void put(char c) {
+        buffer_.push_back(c);
+        flush_if_full();
+    }
+    
+    void put(std::string_view text) {
+        buffer_.append(text);
+        flush_if_full();
+    }
+    
+    void put_number(uint64_t value) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        put(std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+    }
+    
+    void close() {
+        flush();
+        if (std::fclose(file_) != 0) {
+            file_ = nullptr;
+            throw RisError("Could not finish writing: " + path_);
+        }
+        file_ = nullptr;
+    }
+
+private:
+    static constexpr size_t BUFFER_SIZE = 1 << 20;
+    
+    void flush_if_full() {
+        if (buffer_.size() >= BUFFER_SIZE) {
+            flush();
+        }
+    }
+    
+    void flush() {
+        if (!buffer_.empty() && std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size()) {
+            throw RisError("Could not write to: " + path_);
+        }
+        buffer_.clear();
+    }
+    
+    std::string path_;
+    std::FILE* file_;
+    std::string buffer_;
+};
+
+constexpr uint64_t pow10(size_t exponent) {
+    uint64_t result = 1;
+    for (size_t i = 0; i < exponent; ++i) {
+        result *= 10;
+    }
+    return result;
+}
+
+// n rotations of 1..m clicks
+void generate_day_1(OutputFile& out, Rng& rng, uint64_t n, uint64_t m) {
+    for (uint64_t i = 0; i < n; ++i) {
+        out.put(rng.next() & 1 ? 'R' : 'L');
+        out.put_number(rng.between(1, m));
+        out.put('\n');
+    }
+}
+
+// n ranges with bounds of up to m digits, each about 1% of its magnitude wide
+void generate_day_2(OutputFile& out, Rng& rng, uint64_t n, uint64_t m) {
+    if (m < 1 || m > 19) {
+        throw RisError("Day 2 bounds must have between 1 and 19 digits");
+    }
+    for (uint64_t i = 0; i < n; ++i) {
+        size_t digits = static_cast<size_t>(rng.between(1, m));
+        uint64_t start = rng.between(pow10(digits - 1), pow10(digits) - 1);
+        uint64_t end = start + rng.between(0, start / 100);
+        
+        if (i > 0) {
+            out.put(',');
+        }
+        out.put_number(start);
+        out.put('-');
+        out.put_number(end);
+    }
+    out.put('\n');
+}
+
+// n banks of m digits 1-9
+void generate_day_3(OutputFile& out, Rng& rng, uint64_t n, uint64_t m) {
+    if (m < 12) {
+        throw RisError("Day 3 banks need at least 12 batteries");
+    }
+    for (uint64_t i = 0; i < n; ++i) {
+        for (uint64_t j = 0; j < m; ++j) {
+            out.put(static_cast<char>('1' + rng.next() % 9));
+        }
+        out.put('\n');
+    }
+}
+
+// n rows by m columns, roughly 5/8 of the cells holding a roll
+void generate_day_4(OutputFile& out, Rng& rng, uint64_t n, uint64_t m) {
+    for (uint64_t row = 0; row < n; ++row) {
+        for (uint64_t col = 0; col < m; ++col) {
+            out.put(rng.next() % 8 < 5 ? '@' : '.');
+        }
+        out.put('\n');
+    }
+}
+
+// n fresh ranges and m ingredient ids, all in the same 15-digit id space
+void generate_day_5(OutputFile& out, Rng& rng, uint64_t n, uint64_t m) {
+    const uint64_t id_space = pow10(15);
+    const uint64_t max_width = id_space / (n > 0 ? n : 1);
+    
+    for (uint64_t i = 0; i < n; ++i) {
+        uint64_t start = rng.between(1, id_space);
+        out.put_number(start);
+        out.put('-');
+        out.put_number(start + rng.between(0, max_width));
+        out.put('\n');
+    }
+    out.put('\n');
+    for (uint64_t i = 0; i < m; ++i) {
+        out.put_number(rng.between(1, id_space));
+        out.put('\n');
+    }
+}
+
+void print_usage(const char* program_name) {
+    std::cerr << "Usage: " << program_name << " <day_number> <n> [m] [--seed <seed>] [--out <dir>]" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "Writes <dir>/day_N (default dir: current directory)." << std::endl;
+    std::cerr << "  day 1: n rotations of up to m clicks (default m: 1000)" << std::endl;
+    std::cerr << "  day 2: n ranges with bounds of up to m digits (default m: 10, max 19)" << std::endl;
+    std::cerr << "  day 3: n banks of m batteries (default m: 100)" << std::endl;
+    std::cerr << "  day 4: n x m grid (default m: n)" << std::endl;
+    std::cerr << "  day 5: n ranges and m ids (default m: n)" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "Examples:" << std::endl;
+    std::cerr << "  " << program_name << " 1 100000000" << std::endl;
+    std::cerr << "  " << program_name << " 2 1000 18" << std::endl;
+    std::cerr << "  " << program_name << " 3 1000000 10000" << std::endl;
+    std::cerr << "  " << program_name << " 4 50000 --out inputs" << std::endl;
+    std::cerr << "  " << program_name << " 5 10000000 100000000 --seed 7" << std::endl;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    try {
+        int day_num = std::stoi(argv[1]);
+        uint64_t n = std::stoull(argv[2]);
+        std::optional<uint64_t> m;
+        uint64_t seed = 2025;
+        std::string out_dir = ".";
+        
+        for (int i = 3; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--seed" && i + 1 < argc) {
+                seed = std::stoull(argv[++i]);
+            } else if (arg == "--out" && i + 1 < argc) {
+                out_dir = argv[++i];
+            } else if (!m && arg[0] != '-') {
+                m = std::stoull(arg);
+            } else {
+                print_usage(argv[0]);
+                return 1;
+            }
+        }
+        
+        if (!out_dir.empty() && out_dir.back() != '/' && out_dir.back() != '\\') {
+            out_dir += "/";
+        }
+        std::string path = out_dir + "day_" + std::to_string(day_num);
+        
+        // Mix the day into the seed so equal seeds don't give correlated days
+        Rng rng(seed * 31 + static_cast<uint64_t>(day_num));
+        OutputFile out(path);
+        
+        switch (day_num) {
+            case 1: generate_day_1(out, rng, n, m.value_or(1000)); break;
+            case 2: generate_day_2(out, rng, n, m.value_or(10)); break;
+            case 3: generate_day_3(out, rng, n, m.value_or(100)); break;
+            case 4: generate_day_4(out, rng, n, m.value_or(n)); break;
+            case 5: generate_day_5(out, rng, n, m.value_or(n)); break;
+            default:
+                std::cerr << "Error: No generator for day " << day_num << std::endl;
+                return 1;
+        }
+        
+        out.close();
+        std::cout << "wrote " << path << std::endl;
+        return 0;
+    } catch (const RisError& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: Invalid argument (" << e.what() << ")" << std::endl;
+        return 1;
+    }
+}
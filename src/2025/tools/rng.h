@@ -0,0 +1,28 @@
+// SPDX-FileCopyrightText: 2025 SternXD
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <cstdint>
+
+// splitmix64: tiny, fast, and identical on every platform (unlike <random> distributions)
+class Rng {
+public:
+    explicit Rng(uint64_t seed) : state_(seed) {}
+    
+    uint64_t next() {
+        uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    
+    // Uniform in [low, high]
+    uint64_t between(uint64_t low, uint64_t high) {
+        uint64_t span = high - low + 1;
+        return span == 0 ? next() : low + next() % span;
+    }
+
+private:
+    uint64_t state_;
+};